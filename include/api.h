@@ -0,0 +1,11 @@
+#ifndef API_H
+#define API_H
+
+#include <WiFiManager.h>
+
+#define API_BUF_SIZE 768 // response buffer, shared by the handlers, they all run in the wm_portal task
+
+//Registers /api/status, /api/config and the /events display mirror on every portal web server the manager starts
+void apiBegin(WiFiManager &manager);
+
+#endif
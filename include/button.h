@@ -0,0 +1,38 @@
+#ifndef BUTTON_H
+#define BUTTON_H
+
+#include <Arduino.h>
+
+//Debounce and gesture timing
+#define BTN_DEBOUNCE_MS 15   // quiet time after the last edge before the level is trusted
+#define BTN_DOUBLE_MS   200  // second press within this time after a release is a double click
+#define BTN_HOLD_MS     3000 // press held this long is a hold
+#define BTN_QUEUE_LEN   16   // pending events, oldest are kept when full
+
+//Gestures reported by the button engine
+enum button_gesture_t {
+  BTN_DOWN,         // debounced press
+  BTN_UP,           // debounced release, always sent, also after a hold
+  BTN_CLICK,        // single press, sent once the double click window closed
+  BTN_DOUBLE,       // second press within BTN_DOUBLE_MS, sent on its press
+  BTN_HOLD,         // held for BTN_HOLD_MS, sent while still held
+  BTN_HOLD_RELEASE  // released after a hold, sent after its BTN_UP
+};
+
+struct button_event_t {
+  button_gesture_t gesture;
+  int64_t us; // esp_timer time of the first edge that caused the event
+};
+
+//Starts the edge interrupt and debounce timers, activeHigh for the capacitive button
+void buttonBegin(uint8_t pin, bool activeHigh = true);
+//Pops the next gesture, waits up to wait ticks, false on timeout
+bool buttonGetEvent(button_event_t &ev, TickType_t wait = 0);
+//Waits up to wait ticks for an event without taking it
+bool buttonWait(TickType_t wait);
+//Debounced button state
+bool buttonPressed();
+//Drops pending events
+void buttonFlush();
+
+#endif
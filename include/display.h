@@ -0,0 +1,27 @@
+#ifndef DISPLAY_H
+#define DISPLAY_H
+
+#include <Arduino.h>
+#include <frame.h>
+
+#define DISPLAY_RING_LEN 4 // frames in flight between the mode and display task
+#define DISPLAY_BRIGHT_MAX 8 // brightness steps, lit eighths of every half wave
+#define DISPLAY_DATA_PIN  5 // shift register DS
+#define DISPLAY_LATCH_PIN 6 // STCP
+#define DISPLAY_CLOCK_PIN 7 // SHCP
+
+//Shift register pins, zero cross multiplexing on zcPin and the display task
+void displayBegin(uint8_t zcPin);
+//Queues a frame for the display task, single producer only, false if the ring is full
+bool displayPost(const frame_t &frame);
+//Last posted frame
+const frame_t &displayFrame();
+//Called by the display task after each commit, must not block
+void displayOnCommit(void (*cb)(const frame_t &frame));
+//Frames rejected because the ring was full
+uint32_t displayDropped();
+//0 (off) to DISPLAY_BRIGHT_MAX, the tubes are blanked part way into every half wave so it doesn't flicker
+void displaySetBrightness(uint8_t level);
+uint8_t displayBrightness();
+
+#endif
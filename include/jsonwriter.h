@@ -0,0 +1,45 @@
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include <Arduino.h>
+
+#define JSON_MAX_DEPTH 8
+
+//Serializes JSON straight into a caller buffer, no allocation. Output that doesn't fit sets
+//overflow and is cut, the buffer stays NUL terminated.
+class JsonWriter {
+  public:
+    JsonWriter(char *buf, size_t size);
+
+    //key is ignored at the top level and inside arrays
+    JsonWriter &beginObject(const char *key = nullptr);
+    JsonWriter &endObject();
+    JsonWriter &beginArray(const char *key = nullptr);
+    JsonWriter &endArray();
+
+    JsonWriter &str(const char *key, const char *value);
+    JsonWriter &num(const char *key, int64_t value);
+    JsonWriter &num(const char *key, double value, uint8_t decimals);
+    JsonWriter &boolean(const char *key, bool value);
+    JsonWriter &null(const char *key);
+
+    const char *c_str() const { return _buf; }
+    size_t length() const { return _len; }
+    bool overflow() const { return _overflow; }
+
+  private:
+    void raw(const char *s, size_t n);
+    void raw(const char *s) { raw(s, strlen(s)); }
+    void quoted(const char *s);
+    void key(const char *k); // separator, and "k": inside objects
+
+    char *_buf;
+    size_t _size;
+    size_t _len = 0;
+    bool _overflow = false;
+    uint8_t _depth = 0;
+    uint32_t _first = 1;  // bit per depth, next value is the first of its container
+    uint32_t _array = 0;  // bit per depth, container is an array
+};
+
+#endif
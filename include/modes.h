@@ -0,0 +1,44 @@
+#ifndef MODES_H
+#define MODES_H
+
+#include <Arduino.h>
+#include <time.h>
+#include "display.h"
+#include "button.h"
+
+#define TICK_MS 10 // mode scheduler period
+
+enum mode_id_t {
+  MODE_CLOCK,
+  MODE_DATE,
+  MODE_STOPWATCH,
+  MODE_DEPOISON,
+  MODE_LIGHTSHOW,
+  MODE_COUNTDOWN,
+  MODE_ALARM,
+  MODE_OTA,
+  MODE_COUNT
+};
+
+//A display mode, update() runs once per tick and must return within the tick budget
+struct clock_mode_t {
+  const char *name;
+  void (*enter)(uint32_t ms, const struct tm &now);
+  //true if frame was changed and should be committed
+  bool (*update)(uint32_t ms, const struct tm &now, frame_t &frame);
+  void (*event)(const button_event_t &ev, uint32_t ms);
+};
+
+//Switches mode, the new mode gets its enter() before the next update()
+void modeSwitch(mode_id_t id);
+mode_id_t modeCurrent();
+const char *modeName(mode_id_t id);
+//True if the current mode only changes with the second or a button event
+bool modeIdle();
+//Per tick entry points for the scheduler
+void modeEvent(const button_event_t &ev, uint32_t ms);
+bool modeUpdate(uint32_t ms, const struct tm &now, frame_t &frame);
+//Firmware upload progress 0-100 from any task, -1 when it ended, switches to and from MODE_OTA
+void modeShowProgress(int percent);
+
+#endif
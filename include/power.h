@@ -0,0 +1,36 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include <Arduino.h>
+
+#define PWR_MAX_MHZ 160
+#define PWR_MIN_MHZ 40  // XTAL, DFS floor between ticks
+
+//Residency states, the highest one requested wins
+enum power_state_t {
+  PWR_IDLE,   // mode task waits for the next second or a button event
+  PWR_TICK,   // mode task ticks every TICK_MS, DFS and light sleep still allowed
+  PWR_ACTIVE, // cpu held at PWR_MAX_MHZ, no light sleep
+  PWR_COUNT
+};
+
+//powerActive() clients
+#define PWR_CLIENT_NET 0 // WiFi connect, sntp and portal
+
+//Configures DFS with automatic light sleep, falls back to DFS only if the core has no tickless idle
+void powerBegin();
+//True if automatic light sleep got enabled
+bool powerLightSleep();
+//Mode task residency, PWR_IDLE or PWR_TICK
+void powerModes(power_state_t state);
+//Holds the cpu at full speed while any client asks for it, client is a bit 0..31
+void powerActive(uint8_t client, bool on);
+//Attaches isr as a level interrupt armed for the opposite of the current level, which doubles
+//as light sleep wake source. The isr has to call powerRearm() first.
+void powerAttachWake(uint8_t pin, void (*isr)());
+//Flips the interrupt/wake level of pin, returns the level it had
+bool powerRearm(uint8_t pin);
+//Time spent per state since the last call
+void powerStats(Print &out);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+
+//Hot path spans, built with -D NIXIE_PROFILE, everything below compiles to nothing otherwise
+enum prof_span_t {
+  PROF_ISR,       // zero cross shift out
+  PROF_ENCODE,    // digits to pin words
+  PROF_TIMEREAD,  // rtc.getTimeStruct()
+  PROF_HTTP,      // portal/web handling
+  PROF_TICK,      // one mode scheduler tick
+  PROF_SECOND,    // how late a second change is seen, in us not cycles
+  PROF_COUNT
+};
+
+#define PROF_BUCKETS 32 // log2 buckets, bucket n counts values in [2^(n-1), 2^n)
+
+#ifdef NIXIE_PROFILE
+#include <hal/cpu_hal.h>
+
+//Records value for span, safe from ISRs
+void profAdd(prof_span_t span, uint32_t value);
+//Prints count, avg, max and the non empty buckets of every span, reset clears them afterwards
+void profDump(Print &out, bool reset = true);
+
+//Times the enclosing scope in cpu cycles
+struct prof_scope_t {
+  prof_span_t span;
+  uint32_t start;
+  inline prof_scope_t(prof_span_t s) : span(s), start(cpu_hal_get_cycle_count()) {}
+  inline ~prof_scope_t() { profAdd(span, cpu_hal_get_cycle_count() - start); }
+};
+
+#define PROF_SCOPE(span)        prof_scope_t _prof_scope(span)
+#define PROF_VALUE(span, value) profAdd(span, value)
+#define PROF_DUMP(out)          profDump(out)
+#else
+#define PROF_SCOPE(span)
+#define PROF_VALUE(span, value)
+#define PROF_DUMP(out)
+#endif
+
+#endif
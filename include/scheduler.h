@@ -0,0 +1,31 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include <time.h>
+#include <schedwheel.h>
+
+#define SCHED_CATCHUP  300  // seconds stepped through after a small clock jump, larger jumps rebuild
+#define SCHED_STALE    60   // one shot rules overdue by more than this at rebuild are dropped
+#define SCHED_VERSION  1    // NVS layout of sched_rule_t
+
+typedef void (*sched_fire_t)(const sched_rule_t &rule);
+
+//Loads the rules from NVS, or the default lightshows and resync, and builds the wheel at now
+void schedBegin(sched_fire_t fire, time_t now);
+//Advances the wheel to now, O(1) per elapsed second, fires due rules after releasing the lock
+void schedTick(time_t now);
+//Recomputes every due time from now, after a resync or timezone change
+void schedRebuild(time_t now);
+//Adds and persists a rule, returns its slot or -1 if full
+int schedAdd(const sched_rule_t &rule);
+bool schedRemove(int slot);
+//Rule and next due time of a slot, false if the slot is free
+bool schedGet(int slot, sched_rule_t &rule, time_t &due);
+//Slot of the countdown ending first, -1 if none runs
+int schedNextCountdown();
+//Replaces the daily rules of an action with one at hh:00 on every day for each bit set in hours,
+//bit 0 is midnight, persists only if that changes them, returns how many hours didn't fit
+int schedSetHours(uint8_t action, uint32_t hours);
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <Arduino.h>
+#include <WiFiManager.h>
+#include "timesync.h"
+
+#define SETTINGS_VERSION  1  // NVS layout of settings_t, anything else loads the defaults
+#define SETTINGS_NTP_LEN  40 // NTP server name, including the NUL
+#define SETTINGS_PIN_MAX  21 // highest ESP32-C3 GPIO
+#define SETTINGS_OFFSET_MAX (14 * 3600) // s, gmt and daylight offsets
+
+//Clock configuration, stored as one binary record with a CRC, never parsed from text at boot
+struct settings_t {
+  char tz[TZ_MAX_LEN];         // POSIX TZ rule
+  char ntp1[SETTINGS_NTP_LEN];
+  char ntp2[SETTINGS_NTP_LEN];
+  int32_t gmtOffset;           // s, until the first sync sets the TZ rule
+  int32_t dstOffset;           // s
+  uint32_t showHours;          // daily lightshow at hh:00 for every set bit, bit 0 is midnight
+  uint8_t brightness;
+  uint8_t buttonPin;           // pins take effect on the next boot
+  uint8_t zcPin;
+  uint8_t reserved;
+};
+
+//Loads the record from NVS, the defaults if it is missing, from another version or corrupt
+void settingsBegin();
+const settings_t &settings();
+//Validates next, stores it and applies what changed live: brightness, NTP servers, TZ rule and
+//the lightshow schedule. Returns nullptr or what was wrong, nothing is changed then
+const char *settingsApply(const settings_t &next);
+//Puts the settings on the portal params page, a submit goes through settingsApply
+void settingsPortal(WiFiManager &wm);
+
+#endif
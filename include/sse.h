@@ -0,0 +1,21 @@
+#ifndef SSE_H
+#define SSE_H
+
+#include <Arduino.h>
+#include <WebServer.h>
+#include "display.h"
+
+#define SSE_MAX_CLIENTS 3     // sockets are scarce, further clients get a 503
+#define SSE_QUEUE_LEN   4     // frames queued per client, the oldest is dropped when full
+#define SSE_KEEPALIVE_MS 15000 // comment line sent to idle clients, finds dead sockets
+#define SSE_STALL_MS    10000 // a client whose socket accepted nothing for this long is dropped
+
+//Hooks the display commits, pump is the task that calls ssePump(), woken with notifyBit
+void sseBegin(TaskHandle_t pump, uint32_t notifyBit);
+//Registers /events on a portal web server
+void sseRoutes(WebServer &server);
+//Sends queued frames without blocking, only ever from the pump task, it owns the sockets
+void ssePump();
+uint8_t sseClients();
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef TASKSTATS_H
+#define TASKSTATS_H
+
+#include <Arduino.h>
+
+#define TASK_STATS_MAX 6 // registered tasks
+
+//Task priorities, display above timekeeping above network, loop() stays at 1
+#define TASK_PRIO_DISPLAY 5
+#define TASK_PRIO_MODES   3
+#define TASK_PRIO_NET     2
+
+//Registers a task for reporting, returns its slot for taskBusy() or -1 when full
+int taskStatsAdd(const char *name, TaskHandle_t handle);
+//Adds work time measured by the task itself, only called from the task owning the slot
+void taskBusy(int slot, uint32_t us);
+//Prints stack high water mark and cpu share since the last call per task
+void taskStatsPrint(Print &out);
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef TIMESYNC_H
+#define TIMESYNC_H
+
+#include <Arduino.h>
+#include <time.h>
+
+#define TZ_MAX_LEN 64 // POSIX TZ rule, including the NUL
+
+//NTP sync bookkeeping, filled by our sntp_sync_time() override
+struct time_sync_t {
+  uint32_t count;     // syncs since boot
+  time_t last;        // epoch of the last sync, 0 if never
+  int64_t offsetUs;   // correction applied by the last sync, server minus local
+  float driftPpm;     // local clock drift from the last two syncs, 0 until known
+};
+
+const time_sync_t &timeSyncStats();
+//Sets and keeps the POSIX timezone rule, false if it doesn't fit
+bool timeSetZone(const char *tz);
+const char *timeZone();
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef ZEROCROSS_H
+#define ZEROCROSS_H
+
+#include <Arduino.h>
+
+//Zero cross PLL, locks onto the rising edges of the detector and switches the multiplex
+//phases from a one shot esp_timer at the predicted edges
+#define ZC_MIN_US       14000  // shortest accepted mains period, ~71Hz
+#define ZC_MAX_US       25000  // longest accepted mains period, 40Hz
+#define ZC_LOCK_EDGES   8      // consistent periods needed to lock
+#define ZC_WINDOW_US    1000   // edges further off the prediction are rejected as noise
+#define ZC_DEBOUNCE_US  2000   // before lock, edges closer than this to the last one are ignored
+#define ZC_HOLDOVER_MS  5000   // flywheel time without valid edges before the lock is reported lost
+#define ZC_LOST_EDGES   16     // edges outside the window in a row that drop the lock and start over
+#define ZC_LIT_FULL     256    // zcSetLit() of a half wave that is never blanked
+#define ZC_HALF_DEFAULT_US 10000 // half wave before the first lock, 50Hz
+
+//Called from the edge ISR or the esp_timer task on every phase switch, high is the positive half wave.
+//Runs inside the PLL's critical section, so never from both at once, keep it short
+typedef void (*zc_phase_t)(bool high);
+//Called the same way once the lit part of a half wave is over
+typedef void (*zc_blank_t)();
+
+void zcBegin(uint8_t pin, zc_phase_t phase, zc_blank_t blank);
+//Lit part of every half wave in 1/ZC_LIT_FULL, blank is called that far into it, 0 and
+//ZC_LIT_FULL never call it, the dimming repeats every half wave so it doesn't flicker
+void zcSetLit(uint16_t lit);
+//Locked and seen a valid edge within ZC_HOLDOVER_MS
+bool zcLocked();
+//Measured mains frequency in Hz, 0 before the first lock
+float zcFrequency();
+//Edges rejected by the outlier window or debounce
+uint32_t zcRejected();
+
+#endif
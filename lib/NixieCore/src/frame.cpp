@@ -0,0 +1,80 @@
+#include "frame.h"
+#include <string.h>
+
+void frameClear(frame_t &frame) {
+  frame.a = 0;
+  frame.b = 0;
+  memset(frame.digit, DIGIT_BLANK, sizeof(frame.digit));
+}
+
+void frameDigits(frame_t &frame, const uint8_t digit[NUM_TUBES]) {
+  //clear pins registers
+  frame.a = 0;
+  frame.b = 0;
+  //odd tubes are on A, even on B, each pair shares a 10 pin range, tube 5/4 at 0, 3/2 at 10, 1/0 at 20
+  for (int i = 0; i < NUM_TUBES; i++) {
+    frame.digit[i] = digit[i];
+    if (digit[i] > 9) {
+      continue; // blank
+    }
+    uint32_t pin = digit[i] + (2 - i/2)*10;
+    if (i % 2 == 1) {
+      frame.a = bit_set(frame.a, pin);
+    }
+    else {
+      frame.b = bit_set(frame.b, pin);
+    }
+  }
+}
+
+void frameAll(frame_t &frame, uint8_t digit) {
+  uint8_t all[NUM_TUBES];
+  memset(all, digit, sizeof(all));
+  frameDigits(frame, all);
+}
+
+void frameRaw(frame_t &frame, uint32_t a, uint32_t b) {
+  frame.a = a;
+  frame.b = b;
+  //recover digits where a tube has exactly one cathode on
+  for (int i = 0; i < NUM_TUBES; i++) {
+    uint32_t pins = ((i % 2 == 1) ? a : b) >> ((2 - i/2)*10) & 0x3FF;
+    frame.digit[i] = (pins && !(pins & (pins - 1))) ? __builtin_ctz(pins) : DIGIT_BLANK;
+  }
+}
+
+void digitsClock(uint8_t digit[NUM_TUBES], const struct tm &now) {
+  framePair(digit, 0, now.tm_sec);
+  framePair(digit, 1, now.tm_min);
+  framePair(digit, 2, now.tm_hour);
+}
+
+void digitsDate(uint8_t digit[NUM_TUBES], const struct tm &now) {
+  framePair(digit, 0, (now.tm_year + 1900) % 100);
+  framePair(digit, 1, now.tm_mon + 1); // Month is zero-based, so adding 1
+  framePair(digit, 2, now.tm_mday);
+}
+
+void digitsElapsed(uint8_t digit[NUM_TUBES], int64_t elapsedUs) {
+  unsigned long elapsedTime = elapsedUs / 1000;
+  framePair(digit, 0, (elapsedTime / 10) % 100);    // hundredths
+  framePair(digit, 1, (elapsedTime / 1000) % 60);   // seconds
+  framePair(digit, 2, (elapsedTime / 60000) % 60);  // minutes
+}
+
+void digitsDuration(uint8_t digit[NUM_TUBES], uint32_t seconds) {
+  framePair(digit, 0, seconds % 60);
+  framePair(digit, 1, (seconds / 60) % 60);
+  framePair(digit, 2, (seconds / 3600) % 100);
+}
+
+void digitsPercent(uint8_t digit[NUM_TUBES], int percent) {
+  memset(digit, DIGIT_BLANK, NUM_TUBES);
+  digit[0] = percent % 10;
+  if (percent >= 10) {
+    digit[1] = (percent / 10) % 10;
+  }
+  if (percent >= 100) {
+    digit[2] = 1;
+  }
+}
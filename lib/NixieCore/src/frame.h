@@ -0,0 +1,55 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stdint.h>
+#include <time.h>
+
+#define NUM_TUBES   6
+#define DIGIT_BLANK 0xFF // tube off
+
+//One display frame, the two 32 bit words are the multiplex phases switched by the zero cross ISR
+/*
+00 987654 3210 9876 543210 98 76543210
+01 000001 0000 0000 000100 00 00000001
+01 000010 0000 0000 001000 00 00000010
+*/
+struct frame_t {
+  uint32_t a;               // PinValuesA, tubes 5,3,1
+  uint32_t b;               // PinValuesB, tubes 4,2,0
+  uint8_t digit[NUM_TUBES]; // shown digits, tube 0 is the rightmost, DIGIT_BLANK if off or not a digit
+};
+
+inline uint32_t bit_set(uint32_t vector, uint32_t n) {
+      return vector | ((uint32_t)1 << n);
+}
+inline uint32_t bit_clr(uint32_t vector, uint32_t n) {
+      return vector & ~((uint32_t)1 << n);
+}
+
+//All tubes off
+void frameClear(frame_t &frame);
+//converts digits into the two 32bit words, that controll the actual nixie pins
+void frameDigits(frame_t &frame, const uint8_t digit[NUM_TUBES]);
+//Same digit on every tube
+void frameAll(frame_t &frame, uint8_t digit);
+//Raw words, for effects that drive the pins directly
+void frameRaw(frame_t &frame, uint32_t a, uint32_t b);
+//Splits a value into tens and units of a tube pair
+inline void framePair(uint8_t digit[NUM_TUBES], int pair, int value) {
+  digit[pair * 2] = value % 10;
+  digit[pair * 2 + 1] = value / 10;
+}
+
+//Digits of the modes, tube 0 is the rightmost
+//hh:mm:ss
+void digitsClock(uint8_t digit[NUM_TUBES], const struct tm &now);
+//yy:mm:dd
+void digitsDate(uint8_t digit[NUM_TUBES], const struct tm &now);
+//mm:ss:hundredths of an elapsed time
+void digitsElapsed(uint8_t digit[NUM_TUBES], int64_t elapsedUs);
+//hh:mm:ss of a duration, hours wrap at 100
+void digitsDuration(uint8_t digit[NUM_TUBES], uint32_t seconds);
+//0-100 on the right tubes without leading zeros, the rest blank
+void digitsPercent(uint8_t digit[NUM_TUBES], int percent);
+
+#endif
@@ -0,0 +1,98 @@
+#include "lightshow.h"
+
+static void push(std::vector<show_step_t> &show, uint32_t a, uint32_t b, uint16_t ms) {
+  show.push_back({a, b, ms});
+}
+
+void showBuild(std::vector<show_step_t> &show, const frame_t &shown, const struct tm &now) {
+  show.clear();
+  show.reserve(320);
+  //blink progresively faster
+  for (int i = 0; i < 20; i++) {
+    push(show, 0, 0, 200-i*10);
+    push(show, shown.a, shown.b, 200-i*10);
+  }
+  //blink fast for a bit
+  for (int i = 0; i < 10; i++) {
+    push(show, 0, 0, 20);
+    push(show, shown.a, shown.b, 20);
+  }
+  push(show, 0, 0, 500);
+  uint32_t PinValuesA = 0;
+  uint32_t PinValuesB = 0;
+  //NUMBER WAVE
+  const int delay_wave = 30;
+  for (int l = 0; l < 9; l++) {
+    for (int i = 2; i >= 0; i--) {
+      PinValuesB = bit_set(PinValuesB, i*10+l);
+      push(show, PinValuesA, PinValuesB, delay_wave);
+      PinValuesA = bit_set(PinValuesA, i*10+l);
+      push(show, PinValuesA, PinValuesB, delay_wave);
+    }
+    for (int i = 2; i >= 0; i--) {
+      PinValuesB = bit_clr(PinValuesB, i*10+l);
+      push(show, PinValuesA, PinValuesB, delay_wave);
+      PinValuesA = bit_clr(PinValuesA, i*10+l);
+      push(show, PinValuesA, PinValuesB, delay_wave);
+    }
+  }
+  //NUMBER PONG
+  const int delay_pong = 70;
+  for (int l = 9; l >= 0; l--) {
+    //shift number l from left to right
+    for (int i = 2; i >= 0; i--) {
+      PinValuesB = bit_set(PinValuesB, i*10+l);
+      push(show, PinValuesA, PinValuesB, delay_pong);
+      PinValuesB = bit_clr(PinValuesB, i*10+l);
+      PinValuesA = bit_set(PinValuesA, i*10+l);
+      push(show, PinValuesA, PinValuesB, delay_pong);
+      PinValuesA = bit_clr(PinValuesA, i*10+l);
+    }
+    //shift the number l one to the right
+    PinValuesB = bit_set(PinValuesB, l);
+    push(show, PinValuesA, PinValuesB, delay_pong);
+    PinValuesB = bit_clr(PinValuesB, l);
+    //shift the number l right to left
+    for (int i = 1; i <= 2; i++) {
+      PinValuesA = bit_set(PinValuesA, i*10+l);
+      push(show, PinValuesA, PinValuesB, delay_pong);
+      PinValuesA = bit_clr(PinValuesA, i*10+l);
+      PinValuesB = bit_set(PinValuesB, i*10+l);
+      push(show, PinValuesA, PinValuesB, delay_pong);
+      PinValuesB = bit_clr(PinValuesB, i*10+l);
+    }
+  }
+  //SHIFT IN CURRENT TIME
+  const int delay_finish = 80;
+  //first shift in hours, then minutes, then seconds
+  const int shiftIn[] = {now.tm_hour/10, now.tm_hour%10, now.tm_min/10, now.tm_min%10, now.tm_sec/10};
+  for (int l = 0; l <= 4; l++) {
+    int display_num = shiftIn[l];
+    for (int i = 5; i >= l; i--) {
+      //selects the 10 pin range of the tube pair
+      int sel_digits = (i/2)*10;
+      if (i%2 == 1) {
+        PinValuesB = bit_set(PinValuesB, sel_digits+display_num);
+        push(show, PinValuesA, PinValuesB, delay_finish);
+        if (i > l) { //clear the bit except for the last cycle, i.e. keep the shifted digits visible
+          PinValuesB = bit_clr(PinValuesB, sel_digits+display_num);
+        }
+      }
+      else {
+        PinValuesA = bit_set(PinValuesA, sel_digits+display_num);
+        push(show, PinValuesA, PinValuesB, delay_finish);
+        if (i > l) {
+          PinValuesA = bit_clr(PinValuesA, sel_digits+display_num);
+        }
+      }
+    }
+  }
+}
+
+size_t showAdvance(const std::vector<show_step_t> &show, size_t step, uint32_t &started, uint32_t ms) {
+  while (step < show.size() && ms - started >= show[step].ms) {
+    started += show[step].ms;
+    step++;
+  }
+  return step;
+}
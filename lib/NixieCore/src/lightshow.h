@@ -0,0 +1,21 @@
+#ifndef LIGHTSHOW_H
+#define LIGHTSHOW_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+#include <vector>
+#include "frame.h"
+
+//One step of the show, raw pin words
+struct show_step_t {
+  uint32_t a, b;
+  uint16_t ms; // how long this step stays on
+};
+
+//Precomputes the whole show: blink the shown frame, number wave, number pong, shift in the time now
+void showBuild(std::vector<show_step_t> &show, const frame_t &shown, const struct tm &now);
+//Step on at ms, started is when step began and moves along with it, show.size() once it is over
+size_t showAdvance(const std::vector<show_step_t> &show, size_t step, uint32_t &started, uint32_t ms);
+
+#endif
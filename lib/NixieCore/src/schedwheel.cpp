@@ -0,0 +1,102 @@
+#include "schedwheel.h"
+#include <string.h>
+
+//mktime does the DST math
+uint32_t schedNextDaily(const sched_rule_t &r, time_t after) {
+  struct tm lt;
+  localtime_r(&after, &lt);
+  uint8_t days = r.days ? r.days : SCHED_EVERYDAY;
+  for (int d = 0; d <= 7; d++) {
+    struct tm c = lt;
+    c.tm_mday += d;
+    c.tm_hour = r.hour;
+    c.tm_min = r.min;
+    c.tm_sec = r.sec;
+    c.tm_isdst = -1;
+    time_t t = mktime(&c); // normalizes the day overflow and fills tm_wday
+    if (t > after && (days & (1 << c.tm_wday))) {
+      return t;
+    }
+  }
+  return 0;
+}
+
+static int listFor(const sched_wheel_t &w, uint32_t t) {
+  if (t < w.cur) {
+    t = w.cur; // overdue, fire on the next step
+  }
+  uint32_t delta = t - w.cur;
+  if (delta < 256) {
+    return WHEEL0 + (t & 0xFF);
+  }
+  if (delta < (1UL << 14)) {
+    return WHEEL1 + ((t >> 8) & 0x3F);
+  }
+  if (delta < (1UL << 20)) {
+    return WHEEL2 + ((t >> 14) & 0x3F);
+  }
+  return WHEEL_OVER;
+}
+
+static void link(sched_wheel_t &w, int i) {
+  int l = listFor(w, w.due[i]);
+  w.list[i] = l;
+  w.next[i] = w.heads[l];
+  w.heads[l] = i;
+}
+
+//Takes a whole list off the wheel, returns its first timer
+static int8_t detach(sched_wheel_t &w, int l) {
+  int8_t i = w.heads[l];
+  w.heads[l] = -1;
+  return i;
+}
+
+static void cascade(sched_wheel_t &w, int l) {
+  for (int8_t i = detach(w, l); i >= 0;) {
+    int8_t n = w.next[i];
+    link(w, i);
+    i = n;
+  }
+}
+
+void wheelReset(sched_wheel_t &w, uint32_t now) {
+  memset(w.heads, 0xff, sizeof(w.heads));
+  memset(w.list, 0xff, sizeof(w.list));
+  w.cur = now;
+}
+
+void wheelAdd(sched_wheel_t &w, int i, uint32_t due) {
+  w.due[i] = due;
+  link(w, i);
+}
+
+void wheelRemove(sched_wheel_t &w, int i) {
+  if (w.list[i] < 0) {
+    return;
+  }
+  for (int8_t *p = &w.heads[w.list[i]]; *p >= 0; p = &w.next[*p]) {
+    if (*p == i) {
+      *p = w.next[i];
+      break;
+    }
+  }
+  w.list[i] = -1;
+}
+
+int8_t wheelStep(sched_wheel_t &w) {
+  uint32_t t = w.cur;
+  if ((t & 0x3FFF) == 0) {
+    cascade(w, WHEEL2 + ((t >> 14) & 0x3F));
+    cascade(w, WHEEL_OVER);
+  }
+  if ((t & 0xFF) == 0) {
+    cascade(w, WHEEL1 + ((t >> 8) & 0x3F));
+  }
+  int8_t fired = detach(w, WHEEL0 + (t & 0xFF));
+  for (int8_t i = fired; i >= 0; i = w.next[i]) {
+    w.list[i] = -1;
+  }
+  w.cur = t + 1;
+  return fired;
+}
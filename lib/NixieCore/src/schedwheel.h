@@ -0,0 +1,68 @@
+#ifndef SCHEDWHEEL_H
+#define SCHEDWHEEL_H
+
+#include <stdint.h>
+#include <time.h>
+
+#define SCHED_MAX      16   // rules, also the timer pool size
+
+enum sched_action_t : uint8_t {
+  SCHED_LIGHTSHOW,
+  SCHED_RESYNC,
+  SCHED_ALARM,
+  SCHED_COUNTDOWN
+};
+
+enum sched_kind_t : uint8_t {
+  SCHED_DAILY, // local hour:min:sec on the days in the mask, follows DST
+  SCHED_ONCE   // absolute epoch second, removed once fired
+};
+
+#define SCHED_EVERYDAY 0x7F // days mask, bit 0 is Sunday like tm_wday
+
+//A scheduled event as stored in NVS
+struct sched_rule_t {
+  uint8_t kind;
+  uint8_t action;
+  uint8_t days;
+  uint8_t hour, min, sec;
+  uint32_t at; // SCHED_ONCE only
+};
+
+//Next local hour:min:sec on an allowed day strictly after after, in the current TZ, 0 if none
+uint32_t schedNextDaily(const sched_rule_t &r, time_t after);
+
+/*
+Hierarchical timer wheel on epoch seconds
+level 0: 256 slots of 1s       due within 256s
+level 1:  64 slots of 256s     due within ~4.5h
+level 2:  64 slots of 16384s   due within ~12 days
+overflow: one list, looked at on every level 2 cascade
+Each second only the level 0 slot of that second is touched, the upper levels are cascaded
+down when the lower one wraps.
+*/
+#define WHEEL0      0
+#define WHEEL1      256
+#define WHEEL2      (256 + 64)
+#define WHEEL_OVER  (256 + 64 + 64)
+#define WHEEL_LISTS (WHEEL_OVER + 1)
+
+//Timers are the slots 0..SCHED_MAX-1, no locking, the owner serializes the calls
+struct sched_wheel_t {
+  uint32_t due[SCHED_MAX];
+  int8_t next[SCHED_MAX];   // list links, -1 ends a list
+  int16_t list[SCHED_MAX];  // list the timer is on, -1 if none
+  int8_t heads[WHEEL_LISTS];
+  uint32_t cur;             // next second to process
+};
+
+//Empties the wheel, now is the next second to process
+void wheelReset(sched_wheel_t &w, uint32_t now);
+//Puts timer i on the wheel at due, overdue ones fire on the next step
+void wheelAdd(sched_wheel_t &w, int i, uint32_t due);
+void wheelRemove(sched_wheel_t &w, int i);
+//Processes second cur and moves on, returns the timers due then, linked by next, -1 if none.
+//They are off the wheel, the caller adds the repeating ones back after reading their next
+int8_t wheelStep(sched_wheel_t &w);
+
+#endif
@@ -0,0 +1,67 @@
+#include "stopwatch.h"
+
+static bool running = false;
+static int64_t startUs = 0;
+static int64_t stopUs = 0;
+static int64_t lastSplitUs = 0;
+
+static sw_lap_t laps[SW_LAPS];
+static uint16_t lapCount = 0; // laps taken since reset
+
+void swReset() {
+  running = false;
+  startUs = stopUs = lastSplitUs = 0;
+  lapCount = 0;
+}
+
+void swStart(int64_t us) {
+  if (running) {
+    return;
+  }
+  //resume keeps the elapsed time
+  startUs = us - (stopUs - startUs);
+  running = true;
+}
+
+void swStop(int64_t us) {
+  if (!running) {
+    return;
+  }
+  stopUs = us;
+  running = false;
+}
+
+bool swRunning() {
+  return running;
+}
+
+int64_t swElapsed(int64_t now) {
+  return (running ? now : stopUs) - startUs;
+}
+
+bool swLap(int64_t us) {
+  if (!running) {
+    return false;
+  }
+  int64_t split = us - startUs;
+  sw_lap_t &lap = laps[lapCount % SW_LAPS];
+  lap.number = lapCount + 1;
+  lap.splitUs = split;
+  lap.lapUs = split - lastSplitUs;
+  lastSplitUs = split;
+  lapCount++;
+  return true;
+}
+
+int swLapsKept() {
+  return lapCount < SW_LAPS ? lapCount : SW_LAPS;
+}
+
+bool swGetLap(int i, sw_lap_t &lap) {
+  int kept = swLapsKept();
+  if (i < 0 || i >= kept) {
+    return false;
+  }
+  lap = laps[(lapCount - kept + i) % SW_LAPS];
+  return true;
+}
@@ -0,0 +1,29 @@
+#ifndef STOPWATCH_H
+#define STOPWATCH_H
+
+#include <stdint.h>
+
+#define SW_LAPS 16 // laps kept for recall, older ones are overwritten
+
+//One lap, times in us since start
+struct sw_lap_t {
+  uint16_t number; // 1 based, keeps counting when the ring wraps
+  int64_t splitUs; // total time at the lap press
+  int64_t lapUs;   // time since the previous lap
+};
+
+//Stopwatch engine, all times are esp_timer us, normally the button ISR edge time
+void swReset();
+void swStart(int64_t us);
+void swStop(int64_t us);
+bool swRunning();
+//Elapsed time at now, frozen while stopped
+int64_t swElapsed(int64_t now);
+//Records a lap at us, false if not running
+bool swLap(int64_t us);
+//Laps held in the ring, 0..SW_LAPS
+int swLapsKept();
+//Lap i of the kept ones, 0 is the oldest
+bool swGetLap(int i, sw_lap_t &lap);
+
+#endif
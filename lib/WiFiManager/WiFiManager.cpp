@@ -11,6 +11,9 @@
  */
 
 #include "WiFiManager.h"
+#ifdef WM_DEBUG_RINGSIZE
+#include <StreamString.h>
+#endif
 
 #if defined(ESP8266) || defined(ESP32)
 
@@ -18,6 +21,34 @@
 uint8_t WiFiManager::_lastconxresulttmp = WL_IDLE_STATUS;
 #endif
 
+#ifdef WM_CONNECT_EVENTS
+#define WM_CONN_GOTIP  (1 << 0) // station has an ip
+#define WM_CONN_FAILED (1 << 1) // disconnected for a reason retrying won't fix
+
+// reasons the driver reports when this attempt is over, others (leave, beacon loss) may still recover
+static bool connectGaveUp(uint8_t reason){
+  return reason == WIFI_REASON_NO_AP_FOUND || reason == WIFI_REASON_AUTH_FAIL || reason == WIFI_REASON_ASSOC_FAIL
+      || reason == WIFI_REASON_HANDSHAKE_TIMEOUT || reason == WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT;
+}
+
+static uint8_t connectFailStatus(uint8_t reason){
+  return reason == WIFI_REASON_NO_AP_FOUND ? WL_NO_SSID_AVAIL : WL_CONNECT_FAILED;
+}
+#endif
+
+// holds the portal lock for a scope so the portal task never runs process() mid setup or shutdown
+struct WMPortalLock {
+  #ifdef WM_PORTAL_TASK
+  SemaphoreHandle_t _lock;
+  WMPortalLock(WiFiManager *wm) : _lock(wm->_portalLock) { if(_lock) xSemaphoreTakeRecursive(_lock, portMAX_DELAY); }
+  ~WMPortalLock() { release(); }
+  void release() { if(_lock) xSemaphoreGiveRecursive(_lock); _lock = NULL; }
+  #else
+  WMPortalLock(WiFiManager *wm) {}
+  void release() {}
+  #endif
+};
+
 /**
  * --------------------------------------------------------------------------------
  *  WiFiManagerParameter
@@ -144,34 +175,25 @@ bool WiFiManager::addParameter(WiFiManagerParameter *p) {
     }
   }
 
-  // init params if never malloc
-  if(_params == NULL){
+  if(_paramsCount == WM_PARAMS_CAPACITY){
     #ifdef WM_DEBUG_LEVEL
-    DEBUG_WM(WM_DEBUG_DEV,F("allocating params bytes:"),_max_params * sizeof(WiFiManagerParameter*));        
+    DEBUG_WM(WM_DEBUG_ERROR,F("[ERROR] params full, raise WM_PARAMS_CAPACITY:"),WM_PARAMS_CAPACITY);
     #endif
-    _params = (WiFiManagerParameter**)malloc(_max_params * sizeof(WiFiManagerParameter*));
+    return false;
   }
 
-  // resize the params array by increment of WIFI_MANAGER_MAX_PARAMS
-  if(_paramsCount == _max_params){
-    _max_params += WIFI_MANAGER_MAX_PARAMS;
-    #ifdef WM_DEBUG_LEVEL
-    DEBUG_WM(WM_DEBUG_DEV,F("Updated _max_params:"),_max_params);
-    DEBUG_WM(WM_DEBUG_DEV,F("re-allocating params bytes:"),_max_params * sizeof(WiFiManagerParameter*));    
-    #endif
-    WiFiManagerParameter** new_params = (WiFiManagerParameter**)realloc(_params, _max_params * sizeof(WiFiManagerParameter*));
-    #ifdef WM_DEBUG_LEVEL
-    // DEBUG_WM(WIFI_MANAGER_MAX_PARAMS);
-    // DEBUG_WM(_paramsCount);
-    // DEBUG_WM(_max_params);
-    #endif
-    if (new_params != NULL) {
-      _params = new_params;
-    } else {
-      #ifdef WM_DEBUG_LEVEL
-      DEBUG_WM(WM_DEBUG_ERROR,F("[ERROR] failed to realloc params, size not increased!"));
-      #endif
-      return false;
+  // index by id, params sharing an id are chained behind the first
+  _paramNext[_paramsCount] = -1;
+  if(p->getID()){
+    int first = findParameter(p->getID());
+    if(first >= 0){
+      while(_paramNext[first] != -1) first = _paramNext[first];
+      _paramNext[first] = _paramsCount;
+    }
+    else {
+      size_t slot = hashStr(p->getID()) & (WM_PARAMS_INDEX_SIZE - 1);
+      while(_paramIndex[slot] != -1) slot = (slot + 1) & (WM_PARAMS_INDEX_SIZE - 1);
+      _paramIndex[slot] = _paramsCount;
     }
   }
 
@@ -200,6 +222,33 @@ int WiFiManager::getParametersCount() {
   return _paramsCount;
 }
 
+/**
+ * find the first param registered with id
+ * @access public
+ * @param  id param id
+ * @return    param or NULL
+ */
+WiFiManagerParameter* WiFiManager::getParameter(const char *id) {
+  int i = findParameter(id);
+  return i < 0 ? NULL : _params[i];
+}
+
+/**
+ * id hash index lookup
+ * @param  id param id
+ * @return    index into _params of the first param with id, -1 if none
+ */
+int WiFiManager::findParameter(const char *id) {
+  if(!id) return -1;
+  size_t slot = hashStr(id) & (WM_PARAMS_INDEX_SIZE - 1);
+  while(_paramIndex[slot] != -1){
+    const char *pid = _params[_paramIndex[slot]]->getID();
+    if(pid && strcmp(pid, id) == 0) return _paramIndex[slot];
+    slot = (slot + 1) & (WM_PARAMS_INDEX_SIZE - 1);
+  }
+  return -1;
+}
+
 /**
  * --------------------------------------------------------------------------------
  *  WiFiManager 
@@ -218,21 +267,12 @@ WiFiManager::WiFiManager() {
 void WiFiManager::WiFiManagerInit(){
   setMenu(_menuIdsDefault);
   if(_debug && _debugLevel >= WM_DEBUG_DEV) debugPlatformInfo();
-  _max_params = WIFI_MANAGER_MAX_PARAMS;
+  memset(_paramIndex, 0xff, sizeof(_paramIndex)); // all -1
 }
 
 // destructor
 WiFiManager::~WiFiManager() {
   _end();
-  // parameters
-  // @todo below belongs to wifimanagerparameter
-  if (_params != NULL){
-    #ifdef WM_DEBUG_LEVEL
-    DEBUG_WM(WM_DEBUG_DEV,F("freeing allocated params!"));
-    #endif
-    free(_params);
-    _params = NULL;
-  }
 
   // remove event
   // WiFi.onEvent(std::bind(&WiFiManager::WiFiEvent,this,_1,_2));
@@ -277,7 +317,7 @@ boolean WiFiManager::autoConnect() {
  */
 boolean WiFiManager::autoConnect(char const *apName, char const *apPassword) {
   #ifdef WM_DEBUG_LEVEL
-  DEBUG_WM(F("AutoConnect"));
+  DEBUG_WM(WM_DEBUG_NOTIFY,F("AutoConnect"));
   #endif
 
   // bool wifiIsSaved = getWiFiIsSaved();
@@ -339,19 +379,28 @@ boolean WiFiManager::autoConnect(char const *apName, char const *apPassword) {
     if (WiFi.status() == WL_CONNECTED){
       connected = true;
       #ifdef WM_DEBUG_LEVEL
-      DEBUG_WM(F("AutoConnect: ESP Already Connected"));
+      DEBUG_WM(WM_DEBUG_NOTIFY,F("AutoConnect: ESP Already Connected"));
       #endif
       setSTAConfig();
       // @todo not sure if this is safe, causes dup setSTAConfig in connectwifi,
       // and we have no idea WHAT we are connected to
     }
 
+    #ifdef WM_CRED_STORE
+    // the saved network failed, try the other stored ones in range before the portal
+    if(!connected && connectWifi(_defaultssid, _defaultpass) != WL_CONNECTED){
+      connected = connectStored(_defaultssid != "" ? _defaultssid : WiFi_SSID(true)) == WL_CONNECTED;
+    }
+    else connected = true;
+    if(connected){
+    #else
     if(connected || connectWifi(_defaultssid, _defaultpass) == WL_CONNECTED){
+    #endif
       //connected
       #ifdef WM_DEBUG_LEVEL
-      DEBUG_WM(F("AutoConnect: SUCCESS"));
+      DEBUG_WM(WM_DEBUG_NOTIFY,F("AutoConnect: SUCCESS"));
       DEBUG_WM(WM_DEBUG_VERBOSE,F("Connected in"),(String)((millis()-_startconn)) + " ms");
-      DEBUG_WM(F("STA IP Address:"),WiFi.localIP());
+      DEBUG_WM(WM_DEBUG_NOTIFY,F("STA IP Address:"),WiFi.localIP());
       #endif
       // Serial.println("Connected in " + (String)((millis()-_startconn)) + " ms");
       _lastconxresult = WL_CONNECTED;
@@ -365,7 +414,7 @@ boolean WiFiManager::autoConnect(char const *apName, char const *apPassword) {
     }
 
     #ifdef WM_DEBUG_LEVEL
-    DEBUG_WM(F("AutoConnect: FAILED for "),(String)((millis()-_startconn)) + " ms");
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("AutoConnect: FAILED for "),(String)((millis()-_startconn)) + " ms");
     #endif
   // }
   // else {
@@ -463,7 +512,7 @@ bool WiFiManager::setupHostname(bool restart){
 bool WiFiManager::startAP(){
   bool ret = true;
   #ifdef WM_DEBUG_LEVEL
-  DEBUG_WM(F("StartAP with SSID: "),_apName);
+  DEBUG_WM(WM_DEBUG_NOTIFY,F("StartAP with SSID: "),_apName);
   #endif
 
   #ifdef ESP8266
@@ -480,7 +529,7 @@ bool WiFiManager::startAP(){
   // setup optional soft AP static ip config
   if (_ap_static_ip) {
     #ifdef WM_DEBUG_LEVEL
-    DEBUG_WM(F("Custom AP IP/GW/Subnet:"));
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("Custom AP IP/GW/Subnet:"));
     #endif
     if(!WiFi.softAPConfig(_ap_static_ip, _ap_static_gw, _ap_static_sn)){
       #ifdef WM_DEBUG_LEVEL
@@ -530,7 +579,7 @@ bool WiFiManager::startAP(){
   delay(500); // slight delay to make sure we get an AP IP
   #ifdef WM_DEBUG_LEVEL
   if(!ret) DEBUG_WM(WM_DEBUG_ERROR,F("[ERROR] There was a problem starting the AP"));
-  DEBUG_WM(F("AP IP address:"),WiFi.softAPIP());
+  DEBUG_WM(WM_DEBUG_NOTIFY,F("AP IP address:"),WiFi.softAPIP());
   #endif
 
   // set ap hostname
@@ -554,10 +603,14 @@ bool WiFiManager::startAP(){
  * @return {[type]} [description]
  */
 void WiFiManager::startWebPortal() {
+  WMPortalLock lock(this);
   if(configPortalActive || webPortalActive) return;
   connect = abort = false;
   setupConfigPortal();
   webPortalActive = true;
+  #ifdef WM_PORTAL_TASK
+  if(_portalTask) xTaskNotifyGive(_portalTask);
+  #endif
 }
 
 /**
@@ -566,6 +619,7 @@ void WiFiManager::startWebPortal() {
  * @return {[type]} [description]
  */
 void WiFiManager::stopWebPortal() {
+  WMPortalLock lock(this);
   if(!configPortalActive && !webPortalActive) return;
   #ifdef WM_DEBUG_LEVEL
   DEBUG_WM(WM_DEBUG_VERBOSE,F("Stopping Web Portal"));  
@@ -586,6 +640,7 @@ boolean WiFiManager::configPortalHasTimeout(){
         #ifdef WM_DEBUG_LEVEL
         DEBUG_WM(WM_DEBUG_VERBOSE,F("NUM CLIENTS: "),(String)WiFi_softap_num_stations());
         #endif
+        LOG_WM(WM_DEBUG_VERBOSE,WM_LOG_CLIENTS,WiFi_softap_num_stations());
       }
       _configPortalStart = millis(); // kludge, bump configportal start time to skew timeouts
       return false;
@@ -597,8 +652,9 @@ boolean WiFiManager::configPortalHasTimeout(){
     // handle timed out
     if(millis() > _configPortalStart + _configPortalTimeout){
       #ifdef WM_DEBUG_LEVEL
-      DEBUG_WM(F("config portal has timed out"));
+      DEBUG_WM(WM_DEBUG_NOTIFY,F("config portal has timed out"));
       #endif
+      LOG_WM(WM_DEBUG_NOTIFY,WM_LOG_TIMEOUT,millis()-_configPortalStart);
       return true; // timeout bail, else do debug logging
     } 
     else if(_debug && _debugLevel > 0) {
@@ -617,7 +673,7 @@ boolean WiFiManager::configPortalHasTimeout(){
 void WiFiManager::setupHTTPServer(){
 
   #ifdef WM_DEBUG_LEVEL
-  DEBUG_WM(F("Starting Web Portal"));
+  DEBUG_WM(WM_DEBUG_NOTIFY,F("Starting Web Portal"));
   #endif
 
   if(_httpPort != 80) {
@@ -627,6 +683,7 @@ void WiFiManager::setupHTTPServer(){
   }
 
   server.reset(new WM_WebServer(_httpPort));
+  _serverLocIp = 0; // port may have changed, rebuild the redirect on the first request
   // This is not the safest way to reset the webserver, it can cause crashes on callbacks initilized before this and since its a shared pointer...
 
   if ( _webservercallback != NULL) {
@@ -652,27 +709,47 @@ void WiFiManager::setupHTTPServer(){
   server->on(WM_G(R_close),      std::bind(&WiFiManager::handleClose, this));
   server->on(WM_G(R_erase),      std::bind(&WiFiManager::handleErase, this, false));
   server->on(WM_G(R_status),     std::bind(&WiFiManager::handleWiFiStatus, this));
+  #ifdef WM_DEBUG_RINGSIZE
+  server->on(WM_G(R_log),        std::bind(&WiFiManager::handleLog, this));
+  #endif
   server->onNotFound (std::bind(&WiFiManager::handleNotFound, this));
+
+  #ifdef WM_ASSETS_GZ
+  const char * headerkeys[] = { "If-None-Match" }; // HTTP_HEAD_INM, needed for asset revalidation, not PROGMEM, server copies it into a String
+  server->collectHeaders(headerkeys, sizeof(headerkeys)/sizeof(headerkeys[0]));
+  server->on(WM_G(R_css), std::bind(&WiFiManager::handleAsset, this, WM_ASSET_CSS_GZ, WM_ASSET_CSS_LEN, WM_ASSET_CSS_ETAG, HTTP_HEAD_CT_CSS));
+  server->on(WM_G(R_js),  std::bind(&WiFiManager::handleAsset, this, WM_ASSET_JS_GZ,  WM_ASSET_JS_LEN,  WM_ASSET_JS_ETAG,  HTTP_HEAD_CT_JS));
+  #endif
   
   server->on(WM_G(R_update), std::bind(&WiFiManager::handleUpdate, this));
   server->on(WM_G(R_updatedone), HTTP_POST, std::bind(&WiFiManager::handleUpdateDone, this), std::bind(&WiFiManager::handleUpdating, this));
   
   server->begin(); // Web server start
+  #ifdef WM_PORTAL_TASK
+  _httpFd = findSocket(SOCK_STREAM, _httpPort);
+  #endif
   #ifdef WM_DEBUG_LEVEL
   DEBUG_WM(WM_DEBUG_VERBOSE,F("HTTP server started"));
   #endif
 }
 
 void WiFiManager::setupDNSD(){
-  dnsServer.reset(new DNSServer());
+  dnsServer.reset(new WM_DNSServer());
 
   /* Setup the DNS server redirecting all the domains to the apIP */
+  #ifndef WM_DNS_RESPONDER
   dnsServer->setErrorReplyCode(DNSReplyCode::NoError);
+  #endif
   #ifdef WM_DEBUG_LEVEL
   // DEBUG_WM("dns server started port: ",DNS_PORT);
   DEBUG_WM(WM_DEBUG_DEV,F("dns server started with ip: "),WiFi.softAPIP()); // @todo not showing ip
   #endif
   dnsServer->start(DNS_PORT, F("*"), WiFi.softAPIP());
+  #if defined(WM_PORTAL_TASK) && defined(WM_DNS_RESPONDER)
+  _dnsFd = dnsServer->fd();
+  #elif defined(WM_PORTAL_TASK)
+  _dnsFd = findSocket(SOCK_DGRAM, DNS_PORT);
+  #endif
 }
 
 void WiFiManager::setupConfigPortal() {
@@ -694,6 +771,7 @@ boolean WiFiManager::startConfigPortal() {
  * @return {[type]}      [description]
  */
 boolean  WiFiManager::startConfigPortal(char const *apName, char const *apPassword) {
+  WMPortalLock lock(this); // released before the blocking loop
   _begin();
 
   if(configPortalActive){
@@ -737,6 +815,7 @@ boolean  WiFiManager::startConfigPortal(char const *apName, char const *apPasswo
   uint8_t state;
 
   _configPortalStart = millis();
+  LOG_WM(WM_DEBUG_NOTIFY,WM_LOG_PORTAL,_configPortalTimeout/1000);
 
   // start access point
   #ifdef WM_DEBUG_LEVEL
@@ -770,8 +849,12 @@ boolean  WiFiManager::startConfigPortal(char const *apName, char const *apPasswo
       DEBUG_WM(WM_DEBUG_VERBOSE,F("Config Portal Running, non blocking (processing)"));
       if(_configPortalTimeout > 0) DEBUG_WM(WM_DEBUG_VERBOSE,F("Portal Timeout In"),(String)(_configPortalTimeout/1000) + (String)F(" seconds"));
     #endif
+    #ifdef WM_PORTAL_TASK
+    if(_portalTask) xTaskNotifyGive(_portalTask);
+    #endif
     return result; // skip blocking loop
   }
+  lock.release();
 
   // enter blocking loop, waiting for config
   
@@ -811,7 +894,11 @@ boolean  WiFiManager::startConfigPortal(char const *apName, char const *apPasswo
 
     if(!configPortalActive) break;
 
+    #ifdef WM_PORTAL_TASK
+    waitPortalEvent(WM_PORTAL_IDLE_MS); // sleeps until a request or dns query arrives
+    #else
     yield(); // watchdog
+    #endif
   }
 
   #ifdef WM_DEBUG_LEVEL
@@ -826,6 +913,9 @@ boolean  WiFiManager::startConfigPortal(char const *apName, char const *apPasswo
  * @return bool connected
  */
 boolean WiFiManager::process(){
+    #ifdef WM_PORTAL_TASK
+    if(_portalTask && xTaskGetCurrentTaskHandle() != _portalTask) return false; // the task does it
+    #endif
     // process mdns, esp32 not required
     #if defined(WM_MDNS) && defined(ESP8266)
     MDNS.update();
@@ -890,11 +980,11 @@ uint8_t WiFiManager::processConfigPortal(){
         if (res || (!_connectonsave)) {
           #ifdef WM_DEBUG_LEVEL
           if(!_connectonsave){
-            DEBUG_WM(F("SAVED with no connect to new AP"));
+            DEBUG_WM(WM_DEBUG_NOTIFY,F("SAVED with no connect to new AP"));
           } else {
-            DEBUG_WM(F("Connect to new AP [SUCCESS]"));
-            DEBUG_WM(F("Got IP Address:"));
-            DEBUG_WM(WiFi.localIP());
+            DEBUG_WM(WM_DEBUG_NOTIFY,F("Connect to new AP [SUCCESS]"));
+            DEBUG_WM(WM_DEBUG_NOTIFY,F("Got IP Address:"));
+            DEBUG_WM(WM_DEBUG_NOTIFY,WiFi.localIP());
           }
           #endif
 
@@ -972,13 +1062,25 @@ bool WiFiManager::shutdownConfigPortal(){
   // debug - many open issues aobut port not clearing for use with other servers
   server->stop();
   server.reset();
+  _infoCache.reset();
+  #ifdef WM_PORTAL_TASK
+  _httpFd = -1;
+  #endif
 
   WiFi.scanDelete(); // free wifi scan results
+  _scanItems.clear();
+  _scanItems.shrink_to_fit();
 
   if(!configPortalActive) return false;
 
+  #if defined(WM_DEBUG_LEVEL) && defined(WM_DNS_RESPONDER)
+  DEBUG_WM(WM_DEBUG_DEV,F("dns answered/negative/dropped:"),String(dnsServer->answered()) + "/" + String(dnsServer->negative()) + "/" + String(dnsServer->dropped()));
+  #endif
   dnsServer->stop(); //  free heap ?
   dnsServer.reset();
+  #ifdef WM_PORTAL_TASK
+  _dnsFd = -1;
+  #endif
 
   // turn off AP
   // @todo bug workaround
@@ -1020,6 +1122,9 @@ uint8_t WiFiManager::connectWifi(String ssid, String pass, bool connect) {
   #endif
   uint8_t retry = 1;
   uint8_t connRes = (uint8_t)WL_NO_SSID_AVAIL;
+  #if defined(WM_DEBUG_RINGSIZE) || defined(WM_CRED_STORE)
+  unsigned long connstart = millis();
+  #endif
 
   setSTAConfig();
   //@todo catch failures in set_config
@@ -1037,7 +1142,7 @@ uint8_t WiFiManager::connectWifi(String ssid, String pass, bool connect) {
   if(_connectRetries > 1){
     if(_aggresiveReconn) delay(1000); // add idle time before recon
     #ifdef WM_DEBUG_LEVEL
-      DEBUG_WM(F("Connect Wifi, ATTEMPT #"),(String)retry+" of "+(String)_connectRetries); 
+      DEBUG_WM(WM_DEBUG_NOTIFY,F("Connect Wifi, ATTEMPT #"),(String)retry+" of "+(String)_connectRetries); 
       #endif
   }
   // if ssid argument provided connect to that
@@ -1063,7 +1168,7 @@ uint8_t WiFiManager::connectWifi(String ssid, String pass, bool connect) {
     }
     else {
       #ifdef WM_DEBUG_LEVEL
-      DEBUG_WM(F("No wifi saved, skipping"));
+      DEBUG_WM(WM_DEBUG_NOTIFY,F("No wifi saved, skipping"));
       #endif
     }
   }
@@ -1088,10 +1193,115 @@ uint8_t WiFiManager::connectWifi(String ssid, String pass, bool connect) {
   if(connRes != WL_SCAN_COMPLETED){
     updateConxResult(connRes);
   }
+  LOG_WM(WM_DEBUG_NOTIFY,WM_LOG_CONNECT,connRes,millis()-connstart);
+
+  #ifdef WM_CRED_STORE
+  // connect history, the saved network joins the store on its first success
+  if(connect && connRes != WL_SCAN_COMPLETED){
+    String tried = ssid != "" ? ssid : WiFi_SSID(true);
+    if(connRes == WL_CONNECTED) creds().success(tried.c_str(), (ssid != "" ? pass : WiFi_psk(true)).c_str(), millis()-connstart);
+    else creds().failure(tried.c_str());
+  }
+  #endif
+
+  return connRes;
+}
+
+#ifdef WM_CRED_STORE
+WMCredStore& WiFiManager::creds(){
+  if(!_credsLoaded){
+    _creds.begin();
+    _credsLoaded = true;
+  }
+  return _creds;
+}
+
+const WMCredStore& WiFiManager::getCredStore(){
+  return creds();
+}
+
+/**
+ * connect to the stored networks in range, ranked on the scan snapshot by expected connect time
+ * @access public
+ * @param  String skip ssid to leave out, empty for none
+ * @return uint8_t WL status of the last attempt
+ */
+uint8_t WiFiManager::connectStored(const String &skip){
+  WMCredStore &store = creds();
+  uint8_t connRes = (uint8_t)WL_NO_SSID_AVAIL;
+  if(!store.count()) return connRes;
+
+  WMPortalLock lock(this); // the portal task scans into _scanItems too, released before connecting
+  WiFi_enableSTA(true);
+  WiFi_scanNetworks(_scanItems.empty(),false); // cached snapshot while fresh
+  wm_cred_t tries[WM_CREDS_MAX];
+  uint8_t n = rankStored(tries, skip);
+  lock.release();
 
+  for(uint8_t k = 0; k < n && connRes != WL_CONNECTED; k++){
+    #ifdef WM_DEBUG_LEVEL
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("Connecting to stored AP:"),tries[k].ssid);
+    #endif
+    unsigned long start = millis();
+    wifiConnectNew(tries[k].ssid, tries[k].pass, true, false); // candidates stay out of flash
+    connRes = waitForConnectResult(_connectTimeout ? _connectTimeout : WM_CREDS_TRY_MS);
+    if(connRes == WL_CONNECTED) store.success(tries[k].ssid, tries[k].pass, millis()-start);
+    else store.failure(tries[k].ssid);
+  }
+  if(connRes == WL_CONNECTED) WiFi_saveSTAConfig(); // only the one that connected becomes the saved network
+  updateConxResult(connRes);
   return connRes;
 }
 
+/**
+ * rank the stored networks seen in the scan snapshot by expected connect time
+ * @access public
+ * @param  wm_cred_t* tries receives up to WM_CREDS_MAX entries, quickest first
+ * @param  String skip ssid to leave out, empty for none
+ * @return uint8_t number of entries in tries
+ */
+uint8_t WiFiManager::rankStored(wm_cred_t *tries, const String &skip){
+  WMCredStore &store = creds();
+  WMPortalLock lock(this); // _scanItems
+
+  int8_t rssi[WM_CREDS_MAX];
+  memset(rssi, INT8_MIN, sizeof(rssi));
+  for(const wm_scanitem_t &ap : _scanItems){
+    if(ap.dup) continue; // strongest ap of each ssid only
+    int i = store.find(ap.ssid);
+    if(i >= 0 && skip != ap.ssid) rssi[i] = ap.rssi;
+  }
+  uint8_t order[WM_CREDS_MAX];
+  uint8_t n = store.rank(rssi, order);
+  #ifdef WM_DEBUG_LEVEL
+  DEBUG_WM(WM_DEBUG_VERBOSE,F("Stored networks in range:"),n);
+  #endif
+
+  // copied out, every result reorders the store
+  for(uint8_t k = 0; k < n; k++){
+    tries[k] = store.get(order[k]);
+    #ifdef WM_DEBUG_LEVEL
+    DEBUG_WM(WM_DEBUG_DEV,(String)tries[k].ssid+" expected ms:",store.expectedMs(order[k], rssi[order[k]]));
+    #endif
+  }
+  return n;
+}
+#endif
+
+#ifdef ESP32
+/**
+ * write the running STA config to flash as the saved network, after a connect tried without persistence
+ * set_config with the config already in use does not reconnect
+ */
+void WiFiManager::WiFi_saveSTAConfig(){
+  wifi_config_t conf;
+  if(esp_wifi_get_config(WIFI_IF_STA, &conf) != ESP_OK) return;
+  esp_wifi_set_storage(WIFI_STORAGE_FLASH);
+  esp_wifi_set_config(WIFI_IF_STA, &conf);
+  esp_wifi_set_storage(WIFI_STORAGE_RAM);
+}
+#endif
+
 /**
  * connect to a new wifi ap
  * @since $dev
@@ -1099,16 +1309,20 @@ uint8_t WiFiManager::connectWifi(String ssid, String pass, bool connect) {
  * @param  String pass 
  * @return bool success
  * @return connect only save if false
+ * @param  bool persist save to the default ap config in flash, false to only try it
  */
-bool WiFiManager::wifiConnectNew(String ssid, String pass,bool connect){
+bool WiFiManager::wifiConnectNew(String ssid, String pass,bool connect,bool persist){
   bool ret = false;
+  #ifdef WM_CONNECT_EVENTS
+  connectBegin();
+  #endif
   #ifdef WM_DEBUG_LEVEL
   // DEBUG_WM(WM_DEBUG_DEV,F("CONNECTED: "),WiFi.status() == WL_CONNECTED ? "Y" : "NO");
-  DEBUG_WM(F("Connecting to NEW AP:"),ssid);
+  DEBUG_WM(WM_DEBUG_NOTIFY,F("Connecting to NEW AP:"),ssid);
   DEBUG_WM(WM_DEBUG_DEV,F("Using Password:"),pass);
   #endif
   WiFi_enableSTA(true,storeSTAmode); // storeSTAmode will also toggle STA on in default opmode (persistent) if true (default)
-  WiFi.persistent(true);
+  WiFi.persistent(persist);
   ret = WiFi.begin(ssid.c_str(), pass.c_str(), 0, NULL, connect);
   WiFi.persistent(false);
   #ifdef WM_DEBUG_LEVEL
@@ -1126,7 +1340,7 @@ bool WiFiManager::wifiConnectDefault(){
   bool ret = false;
 
   #ifdef WM_DEBUG_LEVEL
-  DEBUG_WM(F("Connecting to SAVED AP:"),WiFi_SSID(true));
+  DEBUG_WM(WM_DEBUG_NOTIFY,F("Connecting to SAVED AP:"),WiFi_SSID(true));
   DEBUG_WM(WM_DEBUG_DEV,F("Using Password:"),WiFi_psk(true));
   #endif
 
@@ -1138,6 +1352,10 @@ bool WiFiManager::wifiConnectDefault(){
   if(!ret) DEBUG_WM(WM_DEBUG_ERROR,F("[ERROR] wifi enableSta failed"));
   #endif
 
+  #ifdef WM_CONNECT_EVENTS
+  connectBegin();
+  #endif
+
   ret = WiFi.begin();
 
   #ifdef WM_DEBUG_LEVEL
@@ -1177,7 +1395,7 @@ bool WiFiManager::setSTAConfig(){
 
       #ifdef WM_DEBUG_LEVEL
       if(!ret) DEBUG_WM(WM_DEBUG_ERROR,F("[ERROR] wifi config failed"));
-      else DEBUG_WM(F("STA IP set:"),WiFi.localIP());
+      else DEBUG_WM(WM_DEBUG_NOTIFY,F("STA IP set:"),WiFi.localIP());
       #endif
   } 
   else {
@@ -1227,9 +1445,22 @@ uint8_t WiFiManager::waitForConnectResult() {
  * @return uint8_t  WL Status
  */
 uint8_t WiFiManager::waitForConnectResult(uint32_t timeout) {
+  #ifdef WM_CONNECT_EVENTS
+  // the event handler sets a bit the moment dhcp finishes or the driver gives up, nothing to poll
+  if(!_connectEvents) connectBegin();
+  if(WiFi.status() == WL_CONNECTED) return WL_CONNECTED;
+  if(timeout == 0) timeout = WM_CONNECT_DEFAULT_MS;
+  #ifdef WM_DEBUG_LEVEL
+  DEBUG_WM(WM_DEBUG_VERBOSE,timeout,F("ms timeout, waiting for connect event..."));
+  #endif
+  EventBits_t bits = xEventGroupWaitBits(_connectEvents, WM_CONN_GOTIP | WM_CONN_FAILED, pdTRUE, pdFALSE, pdMS_TO_TICKS(timeout));
+  if(bits & WM_CONN_GOTIP) return WL_CONNECTED;
+  if(bits & WM_CONN_FAILED) return connectFailStatus(_disconnectReason);
+  return WiFi.status();
+  #else
   if (timeout == 0){
     #ifdef WM_DEBUG_LEVEL
-    DEBUG_WM(F("connectTimeout not set, ESP waitForConnectResult..."));
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("connectTimeout not set, ESP waitForConnectResult..."));
     #endif
     return WiFi.waitForConnectResult();
   }
@@ -1252,13 +1483,14 @@ uint8_t WiFiManager::waitForConnectResult(uint32_t timeout) {
     delay(100);
   }
   return status;
+  #endif
 }
 
 // WPS enabled? https://github.com/esp8266/Arduino/pull/4889
 #ifdef NO_EXTRA_4K_HEAP
 void WiFiManager::startWPS() {
   #ifdef WM_DEBUG_LEVEL
-  DEBUG_WM(F("START WPS"));
+  DEBUG_WM(WM_DEBUG_NOTIFY,F("START WPS"));
   #endif
   #ifdef ESP8266  
     WiFi.beginWPSConfig();
@@ -1266,7 +1498,7 @@ void WiFiManager::startWPS() {
     // @todo
   #endif
   #ifdef WM_DEBUG_LEVEL
-  DEBUG_WM(F("END WPS"));
+  DEBUG_WM(WM_DEBUG_NOTIFY,F("END WPS"));
   #endif
 }
 #endif
@@ -1275,8 +1507,12 @@ String WiFiManager::getHTTPHead(String title){
   String page;
   page += FPSTR(HTTP_HEAD_START);
   page.replace(FPSTR(T_v), title);
+  #ifdef WM_ASSETS_GZ
+  page += FPSTR(WM_ASSET_HEAD); // cacheable /wm.css /wm.js
+  #else
   page += FPSTR(HTTP_SCRIPT);
   page += FPSTR(HTTP_STYLE);
+  #endif
   page += _customHeadElement;
 
   if(_bodyClass != ""){
@@ -1295,6 +1531,29 @@ void WiFiManager::HTTPSend(const String &content){
   server->send(200, FPSTR(HTTP_HEAD_CT), content);
 }
 
+#ifdef WM_ASSETS_GZ
+/**
+ * HTTPD handler for pre-compressed static assets
+ * replies 304 when the client already holds the current etag
+ */
+void WiFiManager::handleAsset(const uint8_t *gz, size_t len, PGM_P etag, PGM_P type){
+  server->sendHeader(FPSTR(HTTP_HEAD_ETAG), FPSTR(etag));
+  server->sendHeader(FPSTR(HTTP_HEAD_CC), FPSTR(HTTP_HEAD_CC_ASSET)); // @HTTPHEAD send cache
+  if(strcmp_P(server->header(FPSTR(HTTP_HEAD_INM)).c_str(), etag) == 0){
+    #ifdef WM_DEBUG_LEVEL
+    DEBUG_WM(WM_DEBUG_VERBOSE,F("<- HTTP Asset 304"),server->uri());
+    #endif
+    server->send(304);
+    return;
+  }
+  #ifdef WM_DEBUG_LEVEL
+  DEBUG_WM(WM_DEBUG_VERBOSE,F("<- HTTP Asset"),server->uri());
+  #endif
+  server->sendHeader(FPSTR(HTTP_HEAD_CE), FPSTR(HTTP_HEAD_CE_GZIP));
+  server->send_P(200, type, (PGM_P)gz, len);
+}
+#endif
+
 /** 
  * HTTPD handler for page requests
  */
@@ -1348,6 +1607,21 @@ void WiFiManager::handleRoot() {
   // if we can detect these and ignore them that would be great, since they come from the captive portal redirect maybe there is a refferer
 }
 
+#ifdef WM_DEBUG_RINGSIZE
+/**
+ * HTTPD CALLBACK debug ring dump, text/plain
+ */
+void WiFiManager::handleLog() {
+  #ifdef WM_DEBUG_LEVEL
+  DEBUG_WM(WM_DEBUG_VERBOSE,F("<- HTTP Log"));
+  #endif
+  handleRequest();
+  StreamString page;
+  dumpDebugLog(page);
+  server->send(200, FPSTR(HTTP_HEAD_CT2), page);
+}
+#endif
+
 /**
  * HTTPD CALLBACK Wifi config page handler
  */
@@ -1456,8 +1730,17 @@ String WiFiManager::getMenuOut(){
 // }
 
 void WiFiManager::WiFi_scanComplete(int networksFound){
+  WMPortalLock lock(this); // _scanItems, from the event task
+  if(networksFound < 0){
+    #ifdef WM_DEBUG_LEVEL
+    DEBUG_WM(WM_DEBUG_ERROR,F("[ERROR] scan failed"));
+    #endif
+    return; // like a failed sync scan, the last snapshot stays
+  }
   _lastscan = millis();
   _numNetworks = networksFound;
+  WiFi_scanSnapshot(networksFound);
+  LOG_WM(WM_DEBUG_VERBOSE,WM_LOG_SCAN,networksFound,_lastscan-_startscan);
   #ifdef WM_DEBUG_LEVEL
   DEBUG_WM(WM_DEBUG_VERBOSE,F("WiFi Scan ASYNC completed"), "in "+(String)(_lastscan - _startscan)+" ms");  
   DEBUG_WM(WM_DEBUG_VERBOSE,F("WiFi Scan ASYNC found:"),_numNetworks);
@@ -1520,12 +1803,7 @@ bool WiFiManager::WiFi_scanNetworks(bool force,bool async){
         DEBUG_WM(WM_DEBUG_VERBOSE,F("WiFi Scan SYNC started"));
         res = WiFi.scanNetworks();
       }
-      if(res == WIFI_SCAN_FAILED){
-        #ifdef WM_DEBUG_LEVEL
-        DEBUG_WM(WM_DEBUG_ERROR,F("[ERROR] scan failed"));
-        #endif
-      }  
-      else if(res == WIFI_SCAN_RUNNING){
+      if(res == WIFI_SCAN_RUNNING){
         #ifdef WM_DEBUG_LEVEL
         DEBUG_WM(WM_DEBUG_ERROR,F("[ERROR] scan waiting"));
         #endif
@@ -1535,10 +1813,18 @@ bool WiFiManager::WiFi_scanNetworks(bool force,bool async){
           #endif
           delay(100);
         }
-        _numNetworks = WiFi.scanComplete();
+        res = WiFi.scanComplete();
       }
-      else if(res >=0 ) _numNetworks = res;
+      if(res < 0){
+        #ifdef WM_DEBUG_LEVEL
+        DEBUG_WM(WM_DEBUG_ERROR,F("[ERROR] scan failed"));
+        #endif
+        return false; // the driver has no results, keep the last snapshot, count and scan time
+      }
+      _numNetworks = res;
+      WiFi_scanSnapshot(_numNetworks);
       _lastscan = millis();
+      LOG_WM(WM_DEBUG_VERBOSE,WM_LOG_SCAN,_numNetworks,_lastscan-_startscan);
       #ifdef WM_DEBUG_LEVEL
       DEBUG_WM(WM_DEBUG_VERBOSE,F("WiFi Scan completed"), "in "+(String)(_lastscan - _startscan)+" ms");
       #endif
@@ -1552,61 +1838,80 @@ bool WiFiManager::WiFi_scanNetworks(bool force,bool async){
     return false;
 }
 
+/**
+ * capture scan results into _scanItems
+ * copies every ap out of the driver once, sorts by rssi and flags duplicate ssids,
+ * then frees the driver results, page renders only read the snapshot
+ * @param networksFound number of scan results
+ */
+void WiFiManager::WiFi_scanSnapshot(int networksFound){
+  _scanItems.clear();
+  if(networksFound <= 0) return;
+  _scanItems.reserve(networksFound);
+
+  String ssid;
+  ssid.reserve(33);
+  for(int i = 0; i < networksFound; i++){
+    wm_scanitem_t ap;
+    uint8_t *bssid = NULL;
+    #ifdef ESP8266
+    bool hidden;
+    if(!WiFi.getNetworkInfo(i, ssid, ap.enc, ap.rssi, bssid, ap.channel, hidden)) continue;
+    #else
+    if(!WiFi.getNetworkInfo(i, ssid, ap.enc, ap.rssi, bssid, ap.channel)) continue;
+    #endif
+    strncpy(ap.ssid, ssid.c_str(), sizeof(ap.ssid) - 1);
+    ap.ssid[sizeof(ap.ssid) - 1] = '\0';
+    if(bssid) memcpy(ap.bssid, bssid, sizeof(ap.bssid));
+    else memset(ap.bssid, 0, sizeof(ap.bssid));
+    ap.hash = hashStr(ap.ssid);
+    ap.dup  = false;
+    _scanItems.push_back(ap);
+  }
+
+  // RSSI SORT, strongest first
+  std::stable_sort(_scanItems.begin(), _scanItems.end(), [](const wm_scanitem_t &a, const wm_scanitem_t &b) -> bool {
+    return a.rssi > b.rssi;
+  });
+
+  // flag duplicates ( must be RSSI sorted ), open addressed ssid hash set, first seen is strongest
+  size_t slots = 8;
+  while(slots < _scanItems.size() * 2) slots <<= 1;
+  std::vector<int16_t> seen(slots, -1);
+  for(size_t i = 0; i < _scanItems.size(); i++){
+    wm_scanitem_t &ap = _scanItems[i];
+    size_t slot = ap.hash & (slots - 1);
+    while(seen[slot] != -1){
+      const wm_scanitem_t &prev = _scanItems[seen[slot]];
+      if(prev.hash == ap.hash && strcmp(prev.ssid, ap.ssid) == 0){
+        ap.dup = true;
+        break;
+      }
+      slot = (slot + 1) & (slots - 1);
+    }
+    if(!ap.dup) seen[slot] = i;
+  }
+
+  WiFi.scanDelete(); // results are copied, free driver scan memory
+}
+
 String WiFiManager::WiFiManager::getScanItemOut(){
     String page;
 
     if(!_numNetworks) WiFi_scanNetworks(); // scan in case this gets called before any scans
 
-    int n = _numNetworks;
+    int n = _scanItems.size();
     if (n == 0) {
       #ifdef WM_DEBUG_LEVEL
-      DEBUG_WM(F("No networks found"));
+      DEBUG_WM(WM_DEBUG_NOTIFY,F("No networks found"));
       #endif
       page += FPSTR(S_nonetworks); // @token nonetworks
       page += F("<br/><br/>");
     }
     else {
       #ifdef WM_DEBUG_LEVEL
-      DEBUG_WM(n,F("networks found"));
+      DEBUG_WM(WM_DEBUG_NOTIFY,n,F("networks found"));
       #endif
-      //sort networks
-      int indices[n];
-      for (int i = 0; i < n; i++) {
-        indices[i] = i;
-      }
-
-      // RSSI SORT
-      for (int i = 0; i < n; i++) {
-        for (int j = i + 1; j < n; j++) {
-          if (WiFi.RSSI(indices[j]) > WiFi.RSSI(indices[i])) {
-            std::swap(indices[i], indices[j]);
-          }
-        }
-      }
-
-      /* test std:sort
-        std::sort(indices, indices + n, [](const int & a, const int & b) -> bool
-        {
-        return WiFi.RSSI(a) > WiFi.RSSI(b);
-        });
-       */
-
-      // remove duplicates ( must be RSSI sorted )
-      if (_removeDuplicateAPs) {
-        String cssid;
-        for (int i = 0; i < n; i++) {
-          if (indices[i] == -1) continue;
-          cssid = WiFi.SSID(indices[i]);
-          for (int j = i + 1; j < n; j++) {
-            if (cssid == WiFi.SSID(indices[j])) {
-              #ifdef WM_DEBUG_LEVEL
-              DEBUG_WM(WM_DEBUG_VERBOSE,F("DUP AP:"),WiFi.SSID(indices[j]));
-              #endif
-              indices[j] = -1; // set dup aps to index -1
-            }
-          }
-        }
-      }
 
       // token precheck, to speed up replacements on large ap lists
       String HTTP_ITEM_STR = FPSTR(HTTP_ITEM);
@@ -1624,28 +1929,35 @@ String WiFiManager::WiFiManager::getScanItemOut(){
       bool tok_q = HTTP_ITEM_STR.indexOf(FPSTR(T_q)) > 0;
       bool tok_i = HTTP_ITEM_STR.indexOf(FPSTR(T_i)) > 0;
       
-      //display networks in page
-      for (int i = 0; i < n; i++) {
-        if (indices[i] == -1) continue; // skip dups
+      //display networks in page, snapshot is already rssi sorted
+      for (const wm_scanitem_t &ap : _scanItems) {
+        if (_removeDuplicateAPs && ap.dup){
+          #ifdef WM_DEBUG_LEVEL
+          DEBUG_WM(WM_DEBUG_VERBOSE,F("DUP AP:"),ap.ssid);
+          #endif
+          continue; // skip dups
+        }
 
         #ifdef WM_DEBUG_LEVEL
-        DEBUG_WM(WM_DEBUG_VERBOSE,F("AP: "),(String)WiFi.RSSI(indices[i]) + " " + (String)WiFi.SSID(indices[i]));
+        DEBUG_WM(WM_DEBUG_VERBOSE,F("AP: "),(String)ap.rssi + " " + (String)ap.ssid);
         #endif
 
-        int rssiperc = getRSSIasQuality(WiFi.RSSI(indices[i]));
-        uint8_t enc_type = WiFi.encryptionType(indices[i]);
+        int rssiperc = getRSSIasQuality(ap.rssi);
+        uint8_t enc_type = ap.enc;
 
         if (_minimumQuality == -1 || _minimumQuality < rssiperc) {
-          String item = HTTP_ITEM_STR;
-          if(WiFi.SSID(indices[i]) == ""){
-            // Serial.println(WiFi.BSSIDstr(indices[i]));
+          if(ap.ssid[0] == '\0'){
             continue; // No idea why I am seeing these, lets just skip them for now
           }
-          item.replace(FPSTR(T_V), htmlEntities(WiFi.SSID(indices[i]))); // ssid no encoding
-          item.replace(FPSTR(T_v), htmlEntities(WiFi.SSID(indices[i]),true)); // ssid no encoding
+          String item = HTTP_ITEM_STR;
+          char ssidesc[WM_ESCAPE_BUFSIZE]; // fits a fully escaped 32 char ssid
+          htmlEscape(ssidesc, sizeof(ssidesc), ap.ssid, WM_ESC_ATTR);
+          item.replace(FPSTR(T_V), ssidesc); // ssid attribute
+          htmlEscape(ssidesc, sizeof(ssidesc), ap.ssid, WM_ESC_TEXT);
+          item.replace(FPSTR(T_v), ssidesc); // ssid text, spaces nbsp
           if(tok_e) item.replace(FPSTR(T_e), encryptionTypeStr(enc_type));
           if(tok_r) item.replace(FPSTR(T_r), (String)rssiperc); // rssi percentage 0-100
-          if(tok_R) item.replace(FPSTR(T_R), (String)WiFi.RSSI(indices[i])); // rssi db
+          if(tok_R) item.replace(FPSTR(T_R), (String)ap.rssi); // rssi db
           if(tok_q) item.replace(FPSTR(T_q), (String)int(round(map(rssiperc,0,100,1,4)))); //quality icon 1-4
           if(tok_i){
             if (enc_type != WM_WIFIOPEN) {
@@ -1935,6 +2247,26 @@ void WiFiManager::doParamSave(){
     DEBUG_WM(WM_DEBUG_VERBOSE,FPSTR(D_HR));
     #endif
 
+    // single pass over the posted args, slice them onto param slots
+    // param_N wins over an id match, as before
+    int16_t argByPos[WM_PARAMS_CAPACITY];
+    int16_t argById[WM_PARAMS_CAPACITY];
+    memset(argByPos, 0xff, sizeof(argByPos));
+    memset(argById, 0xff, sizeof(argById));
+    const size_t prelen = strlen_P(S_parampre);
+    for (int k = 0; k < server->args(); k++) {
+      String name = server->argName(k);
+      if(strncmp_P(name.c_str(), S_parampre, prelen) == 0 && isDigit(name[prelen])){
+        int i = atoi(name.c_str() + prelen);
+        if(i < _paramsCount && argByPos[i] == -1) argByPos[i] = k;
+        continue;
+      }
+      // first arg wins, chained params sharing the id all read it
+      for (int i = findParameter(name.c_str()); i >= 0; i = _paramNext[i]){
+        if(argById[i] == -1) argById[i] = k;
+      }
+    }
+
     for (int i = 0; i < _paramsCount; i++) {
       if (_params[i] == NULL || _params[i]->_length > 99999) {
         #ifdef WM_DEBUG_LEVEL
@@ -1942,17 +2274,16 @@ void WiFiManager::doParamSave(){
         #endif
         break; // @todo might not be needed anymore
       }
-      //read parameter from server
-      String name = (String)FPSTR(S_parampre)+(String)i;
+      //read parameter from parsed args, missing args clear the value
+      int k = argByPos[i] != -1 ? argByPos[i] : argById[i];
       String value;
-      if(server->hasArg(name)) {
-        value = server->arg(name);
-      } else {
-        value = server->arg(_params[i]->getID());
-      }
+      if(k != -1) value = server->arg(k);
 
-      //store it in params array
-      value.toCharArray(_params[i]->_value, _params[i]->_length+1); // length+1 null terminated
+      //store it in params array, custom html params have no value buffer
+      if(_params[i]->_value){
+        strncpy(_params[i]->_value, value.c_str(), _params[i]->_length);
+        _params[i]->_value[_params[i]->_length] = '\0'; // length+1 null terminated
+      }
       #ifdef WM_DEBUG_LEVEL
       DEBUG_WM(WM_DEBUG_VERBOSE,(String)_params[i]->getID() + ":",value);
       #endif
@@ -1962,355 +2293,293 @@ void WiFiManager::doParamSave(){
     #endif
   }
 
+  LOG_WM(WM_DEBUG_VERBOSE,WM_LOG_PARAMSAVE,_paramsCount);
+
    if ( _saveparamscallback != NULL) {
     _saveparamscallback();  // @CALLBACK
   }
    
 }
 
-/** 
- * HTTPD CALLBACK info page
- */
-void WiFiManager::handleInfo() {
-  #ifdef WM_DEBUG_LEVEL
-  DEBUG_WM(WM_DEBUG_VERBOSE,F("<- HTTP Info"));
-  #endif
-  handleRequest();
-  String page = getHTTPHead(FPSTR(S_titleinfo)); // @token titleinfo
-  reportStatus(page);
-
-  uint16_t infos = 0;
-
-  //@todo convert to enum or refactor to strings
-  //@todo wrap in build flag to remove all info code for memory saving
-  #ifdef ESP8266
-    infos = 28;
-    String infoids[] = {
-      F("esphead"),
-      F("uptime"),
-      F("chipid"),
-      F("fchipid"),
-      F("idesize"),
-      F("flashsize"),
-      F("corever"),
-      F("bootver"),
-      F("cpufreq"),
-      F("freeheap"),
-      F("memsketch"),
-      F("memsmeter"),
-      F("lastreset"),
-      F("wifihead"),
-      F("conx"),
-      F("stassid"),
-      F("staip"),
-      F("stagw"),
-      F("stasub"),
-      F("dnss"),
-      F("host"),
-      F("stamac"),
-      F("autoconx"),
-      F("wifiaphead"),
-      F("apssid"),
-      F("apip"),
-      F("apbssid"),
-      F("apmac")
-    };
-
-  #elif defined(ESP32)
-    // add esp_chip_info ?
-    infos = 27;
-    String infoids[] = {
-      F("esphead"),
-      F("uptime"),
-      F("chipid"),
-      F("chiprev"),
-      F("idesize"),
-      F("flashsize"),      
-      F("cpufreq"),
-      F("freeheap"),
-      F("memsketch"),
-      F("memsmeter"),      
-      F("lastreset"),
-      F("temp"),
-      // F("hall"),
-      F("wifihead"),
-      F("conx"),
-      F("stassid"),
-      F("staip"),
-      F("stagw"),
-      F("stasub"),
-      F("dnss"),
-      F("host"),
-      F("stamac"),
-      F("apssid"),
-      F("wifiaphead"),
-      F("apip"),
-      F("apmac"),
-      F("aphost"),
-      F("apbssid")
-    };
-  #endif
-
-  for(size_t i=0; i<infos;i++){
-    if(infoids[i] != NULL) page += getInfoData(infoids[i]);
-  }
-  page += F("</dl>");
-
-  page += F("<h3>About</h3><hr><dl>");
-  page += getInfoData("aboutver");
-  page += getInfoData("aboutarduinover");
-  page += getInfoData("aboutidfver");
-  page += getInfoData("aboutdate");
-  page += F("</dl>");
-
-  if(_showInfoUpdate){
-    page += HTTP_PORTAL_MENU[8];
-    page += HTTP_PORTAL_MENU[9];
+// bounded buffer for chunked responses, sent to the client whenever it fills up
+struct WMChunkOut {
+  WiFiManager::WM_WebServer &server;
+  size_t len = 0;
+  char   buf[WM_INFO_BUFSIZE];
+
+  explicit WMChunkOut(WiFiManager::WM_WebServer &s) : server(s) {}
+  void add_P(PGM_P s, size_t n){
+    while(n){
+      if(len == sizeof(buf)) flush();
+      size_t c = std::min(n, sizeof(buf) - len);
+      memcpy_P(buf + len, s, c);
+      len += c;
+      s   += c;
+      n   -= c;
+    }
+  }
+  void add_P(PGM_P s){ add_P(s, strlen_P(s)); }
+  void add(const String &s){ add_P(s.c_str(), s.length()); }
+  void flush(){
+    if(len) server.sendContent(buf, len); // never empty, that would end the response
+    len = 0;
+  }
+};
+
+// renders into a String, for rows that are cached
+struct WMStringOut {
+  String &str;
+  void add_P(PGM_P s, size_t n){ while(n--) str += (char)pgm_read_byte(s++); }
+  void add(const String &s){ str += s; }
+};
+
+// copies tpl to out with {1} and {2} filled in, one pass instead of a replace() per token
+template <typename Out> static void infoFill(Out &out, PGM_P tpl, const String &v1, const String &v2){
+  PGM_P run = tpl;
+  for(char c; (c = pgm_read_byte(tpl)); tpl++){
+    if(c != '{') continue;
+    char t = pgm_read_byte(tpl + 1);
+    if((t != '1' && t != '2') || pgm_read_byte(tpl + 2) != '}') continue;
+    out.add_P(run, tpl - run);
+    out.add(t == '1' ? v1 : v2);
+    tpl += 2;
+    run  = tpl + 1;
+  }
+  out.add_P(run, tpl - run);
+}
+
+#if defined(ESP32) && defined(_ROM_RTC_H_)
+static const __FlashStringHelper* infoResetReason(int reason){
+  switch (reason)
+  {
+    case 1  : return F("Vbat power on reset");
+    case 3  : return F("Software reset digital core");
+    case 4  : return F("Legacy watch dog reset digital core");
+    case 5  : return F("Deep Sleep reset digital core");
+    case 6  : return F("Reset by SLC module, reset digital core");
+    case 7  : return F("Timer Group0 Watch dog reset digital core");
+    case 8  : return F("Timer Group1 Watch dog reset digital core");
+    case 9  : return F("RTC Watch dog Reset digital core");
+    case 10 : return F("Instrusion tested to reset CPU");
+    case 11 : return F("Time Group reset CPU");
+    case 12 : return F("Software reset CPU");
+    case 13 : return F("RTC Watch dog Reset CPU");
+    case 14 : return F("for APP CPU, reseted by PRO CPU");
+    case 15 : return F("Reset when the vdd voltage is not stable");
+    case 16 : return F("RTC Watch dog reset digital core and rtc module");
+    default : return F("NO_MEAN");
   }
-  if(_showInfoErase) page += FPSTR(HTTP_ERASEBTN);
-  if(_showBack) page += FPSTR(HTTP_BACKBTN);
-  page += FPSTR(HTTP_HELP);
-  page += FPSTR(HTTP_END);
-
-  HTTPSend(page);
-
-  #ifdef WM_DEBUG_LEVEL
-  DEBUG_WM(WM_DEBUG_DEV,F("Sent info page"));
-  #endif
 }
+#endif
 
-String WiFiManager::getInfoData(String id){
-
-  String p;
-  if(id==F("esphead")){
-    p = FPSTR(HTTP_INFO_esphead);
+/**
+ * info page rows by wm_info_t, template, cached and the values for its tokens
+ * chip, flash, sketch and mac rows are rendered once, the rest on every visit
+ */
+const WiFiManager::wm_infofield_t WiFiManager::_infoFields[] = {
+  { HTTP_INFO_esphead, true, [](WiFiManager &wm, String &v1, String &v2){
     #ifdef ESP32
-      p.replace(FPSTR(T_1), (String)ESP.getChipModel());
+      v1 = ESP.getChipModel();
     #endif
-  }
-  else if(id==F("wifihead")){
-    p = FPSTR(HTTP_INFO_wifihead);
-    p.replace(FPSTR(T_1),getModeString(WiFi.getMode()));
-  }
-  else if(id==F("uptime")){
+  }},
+  { HTTP_INFO_uptime, false, [](WiFiManager &wm, String &v1, String &v2){
     // subject to rollover!
-    p = FPSTR(HTTP_INFO_uptime);
-    p.replace(FPSTR(T_1),(String)(millis() / 1000 / 60));
-    p.replace(FPSTR(T_2),(String)((millis() / 1000) % 60));
-  }
-  else if(id==F("chipid")){
-    p = FPSTR(HTTP_INFO_chipid);
-    p.replace(FPSTR(T_1),String(WIFI_getChipId(),HEX));
-  }
-  #ifdef ESP32
-  else if(id==F("chiprev")){
-      p = FPSTR(HTTP_INFO_chiprev);
-      String rev = (String)ESP.getChipRevision();
-      #ifdef _SOC_EFUSE_REG_H_
-        String revb = (String)(REG_READ(EFUSE_BLK0_RDATA3_REG) >> (EFUSE_RD_CHIP_VER_RESERVE_S)&&EFUSE_RD_CHIP_VER_RESERVE_V);
-        p.replace(FPSTR(T_1),rev+"<br/>"+revb);
-      #else
-        p.replace(FPSTR(T_1),rev);
-      #endif
-  }
+    unsigned long secs = millis() / 1000;
+    v1 = (String)(secs / 60);
+    v2 = (String)(secs % 60);
+  }},
+  { HTTP_INFO_chipid, true, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = String(WIFI_getChipId(),HEX);
+  }},
+  #ifdef ESP8266
+  { HTTP_INFO_fchipid, true, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = (String)ESP.getFlashChipId();
+  }},
+  #elif defined(ESP32)
+  { HTTP_INFO_chiprev, true, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = (String)ESP.getChipRevision();
+    #ifdef _SOC_EFUSE_REG_H_
+      v1 += "<br/>" + (String)(REG_READ(EFUSE_BLK0_RDATA3_REG) >> (EFUSE_RD_CHIP_VER_RESERVE_S)&&EFUSE_RD_CHIP_VER_RESERVE_V);
+    #endif
+  }},
   #endif
+  { HTTP_INFO_idesize, true, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = (String)ESP.getFlashChipSize();
+  }},
   #ifdef ESP8266
-  else if(id==F("fchipid")){
-      p = FPSTR(HTTP_INFO_fchipid);
-      p.replace(FPSTR(T_1),(String)ESP.getFlashChipId());
-  }
+  { HTTP_INFO_flashsize, true, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = (String)ESP.getFlashChipRealSize();
+  }},
+  { HTTP_INFO_corever, true, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = (String)ESP.getCoreVersion();
+  }},
+  { HTTP_INFO_bootver, true, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = (String)system_get_boot_version();
+  }},
+  #elif defined(ESP32)
+  { HTTP_INFO_psrsize, true, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = (String)ESP.getPsramSize();
+  }},
   #endif
-  else if(id==F("idesize")){
-    p = FPSTR(HTTP_INFO_idesize);
-    p.replace(FPSTR(T_1),(String)ESP.getFlashChipSize());
-  }
-  else if(id==F("flashsize")){
-    #ifdef ESP8266
-      p = FPSTR(HTTP_INFO_flashsize);
-      p.replace(FPSTR(T_1),(String)ESP.getFlashChipRealSize());
-    #elif defined ESP32
-      p = FPSTR(HTTP_INFO_psrsize);
-      p.replace(FPSTR(T_1),(String)ESP.getPsramSize());      
-    #endif
-  }
-  else if(id==F("corever")){
-    #ifdef ESP8266
-      p = FPSTR(HTTP_INFO_corever);
-      p.replace(FPSTR(T_1),(String)ESP.getCoreVersion());
-    #endif      
-  }
+  { HTTP_INFO_cpufreq, false, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = (String)ESP.getCpuFreqMHz();
+  }},
+  { HTTP_INFO_freeheap, false, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = (String)ESP.getFreeHeap();
+  }},
+  { HTTP_INFO_memsketch, true, [](WiFiManager &wm, String &v1, String &v2){
+    uint32_t sketch = ESP.getSketchSize();
+    v1 = (String)sketch;
+    v2 = (String)(sketch+ESP.getFreeSketchSpace());
+  }},
+  { HTTP_INFO_memsmeter, true, [](WiFiManager &wm, String &v1, String &v2){
+    uint32_t sketch = ESP.getSketchSize();
+    v1 = (String)sketch;
+    v2 = (String)(sketch+ESP.getFreeSketchSpace());
+  }},
   #ifdef ESP8266
-  else if(id==F("bootver")){
-      p = FPSTR(HTTP_INFO_bootver);
-      p.replace(FPSTR(T_1),(String)system_get_boot_version());
-  }
+  { HTTP_INFO_lastreset, true, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = (String)ESP.getResetReason();
+  }},
+  #elif defined(ESP32) && defined(_ROM_RTC_H_)
+  { HTTP_INFO_lastreset, true, [](WiFiManager &wm, String &v1, String &v2){
+    // requires #include <rom/rtc.h>
+    v1 = infoResetReason(rtc_get_reset_reason(0));
+    v2 = infoResetReason(rtc_get_reset_reason(1));
+  }},
   #endif
-  else if(id==F("cpufreq")){
-    p = FPSTR(HTTP_INFO_cpufreq);
-    p.replace(FPSTR(T_1),(String)ESP.getCpuFreqMHz());
-  }
-  else if(id==F("freeheap")){
-    p = FPSTR(HTTP_INFO_freeheap);
-    p.replace(FPSTR(T_1),(String)ESP.getFreeHeap());
-  }
-  else if(id==F("memsketch")){
-    p = FPSTR(HTTP_INFO_memsketch);
-    p.replace(FPSTR(T_1),(String)(ESP.getSketchSize()));
-    p.replace(FPSTR(T_2),(String)(ESP.getSketchSize()+ESP.getFreeSketchSpace()));
-  }
-  else if(id==F("memsmeter")){
-    p = FPSTR(HTTP_INFO_memsmeter);
-    p.replace(FPSTR(T_1),(String)(ESP.getSketchSize()));
-    p.replace(FPSTR(T_2),(String)(ESP.getSketchSize()+ESP.getFreeSketchSpace()));
-  }
-  else if(id==F("lastreset")){
-    #ifdef ESP8266
-      p = FPSTR(HTTP_INFO_lastreset);
-      p.replace(FPSTR(T_1),(String)ESP.getResetReason());
-    #elif defined(ESP32) && defined(_ROM_RTC_H_)
-      // requires #include <rom/rtc.h>
-      p = FPSTR(HTTP_INFO_lastreset);
-      for(int i=0;i<2;i++){
-        int reason = rtc_get_reset_reason(i);
-        String tok = (String)T_ss+(String)(i+1)+(String)T_es;
-        switch (reason)
-        {
-          //@todo move to array
-          case 1  : p.replace(tok,F("Vbat power on reset"));break;
-          case 3  : p.replace(tok,F("Software reset digital core"));break;
-          case 4  : p.replace(tok,F("Legacy watch dog reset digital core"));break;
-          case 5  : p.replace(tok,F("Deep Sleep reset digital core"));break;
-          case 6  : p.replace(tok,F("Reset by SLC module, reset digital core"));break;
-          case 7  : p.replace(tok,F("Timer Group0 Watch dog reset digital core"));break;
-          case 8  : p.replace(tok,F("Timer Group1 Watch dog reset digital core"));break;
-          case 9  : p.replace(tok,F("RTC Watch dog Reset digital core"));break;
-          case 10 : p.replace(tok,F("Instrusion tested to reset CPU"));break;
-          case 11 : p.replace(tok,F("Time Group reset CPU"));break;
-          case 12 : p.replace(tok,F("Software reset CPU"));break;
-          case 13 : p.replace(tok,F("RTC Watch dog Reset CPU"));break;
-          case 14 : p.replace(tok,F("for APP CPU, reseted by PRO CPU"));break;
-          case 15 : p.replace(tok,F("Reset when the vdd voltage is not stable"));break;
-          case 16 : p.replace(tok,F("RTC Watch dog reset digital core and rtc module"));break;
-          default : p.replace(tok,F("NO_MEAN"));
-        }
-      }
-    #endif
-  }
-  else if(id==F("apip")){
-    p = FPSTR(HTTP_INFO_apip);
-    p.replace(FPSTR(T_1),WiFi.softAPIP().toString());
-  }
-  else if(id==F("apmac")){
-    p = FPSTR(HTTP_INFO_apmac);
-    p.replace(FPSTR(T_1),(String)WiFi.softAPmacAddress());
-  }
-  #ifdef ESP32
-  else if(id==F("aphost")){
-      p = FPSTR(HTTP_INFO_aphost);
-      p.replace(FPSTR(T_1),WiFi.softAPgetHostname());
-  }
+  #if defined(ESP32) && !defined(WM_NOTEMP)
+  { HTTP_INFO_temp, false, [](WiFiManager &wm, String &v1, String &v2){
+    // temperature is not calibrated, varying large offsets are present, use for relative temp changes only
+    float temp = temperatureRead();
+    v1 = (String)temp;
+    v2 = (String)((temp+32)*1.8f);
+  }},
   #endif
-  #ifndef WM_NOSOFTAPSSID
+  { HTTP_INFO_wifihead, false, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = wm.getModeString(WiFi.getMode());
+  }},
+  { HTTP_INFO_conx, false, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = WiFi.isConnected() ? FPSTR(S_y) : FPSTR(S_n);
+  }},
+  { HTTP_INFO_stassid, false, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = wm.htmlEntities((String)wm.WiFi_SSID());
+  }},
+  { HTTP_INFO_staip, false, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = WiFi.localIP().toString();
+  }},
+  { HTTP_INFO_stagw, false, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = WiFi.gatewayIP().toString();
+  }},
+  { HTTP_INFO_stasub, false, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = WiFi.subnetMask().toString();
+  }},
+  { HTTP_INFO_dnss, false, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = WiFi.dnsIP().toString();
+  }},
+  { HTTP_INFO_host, false, [](WiFiManager &wm, String &v1, String &v2){
+    #ifdef ESP32
+      v1 = WiFi.getHostname();
+    #else
+    v1 = WiFi.hostname();
+    #endif
+  }},
+  { HTTP_INFO_stamac, true, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = WiFi.macAddress();
+  }},
   #ifdef ESP8266
-  else if(id==F("apssid")){
-    p = FPSTR(HTTP_INFO_apssid);
-    p.replace(FPSTR(T_1),htmlEntities(WiFi.softAPSSID()));
-  }
+  { HTTP_INFO_autoconx, false, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = WiFi.getAutoConnect() ? FPSTR(S_enable) : FPSTR(S_disable);
+  }},
+  #ifndef WM_NOSOFTAPSSID
+  { HTTP_INFO_apssid, false, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = wm.htmlEntities(WiFi.softAPSSID());
+  }},
   #endif
   #endif
-  else if(id==F("apbssid")){
-    p = FPSTR(HTTP_INFO_apbssid);
-    p.replace(FPSTR(T_1),(String)WiFi.BSSIDstr());
-  }
+  { HTTP_INFO_apip, false, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = WiFi.softAPIP().toString();
+  }},
+  { HTTP_INFO_apmac, true, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = (String)WiFi.softAPmacAddress();
+  }},
+  #ifdef ESP32
+  { HTTP_INFO_aphost, false, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = WiFi.softAPgetHostname();
+  }},
+  #endif
+  { HTTP_INFO_apbssid, false, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = (String)WiFi.BSSIDstr();
+  }},
   // softAPgetHostname // esp32
   // softAPSubnetCIDR
   // softAPNetworkID
   // softAPBroadcastIP
+  { HTTP_INFO_aboutver, true, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = FPSTR(WM_VERSION_STR);
+  }},
+  { HTTP_INFO_aboutarduino, true, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = String(VER_ARDUINO_STR);
+  }},
+  { HTTP_INFO_aboutdate, true, [](WiFiManager &wm, String &v1, String &v2){
+    v1 = String(__DATE__ " " __TIME__);
+  }}
+};
 
-  else if(id==F("stassid")){
-    p = FPSTR(HTTP_INFO_stassid);
-    p.replace(FPSTR(T_1),htmlEntities((String)WiFi_SSID()));
-  }
-  else if(id==F("staip")){
-    p = FPSTR(HTTP_INFO_staip);
-    p.replace(FPSTR(T_1),WiFi.localIP().toString());
-  }
-  else if(id==F("stagw")){
-    p = FPSTR(HTTP_INFO_stagw);
-    p.replace(FPSTR(T_1),WiFi.gatewayIP().toString());
-  }
-  else if(id==F("stasub")){
-    p = FPSTR(HTTP_INFO_stasub);
-    p.replace(FPSTR(T_1),WiFi.subnetMask().toString());
-  }
-  else if(id==F("dnss")){
-    p = FPSTR(HTTP_INFO_dnss);
-    p.replace(FPSTR(T_1),WiFi.dnsIP().toString());
-  }
-  else if(id==F("host")){
-    p = FPSTR(HTTP_INFO_host);
-    #ifdef ESP32
-      p.replace(FPSTR(T_1),WiFi.getHostname());
-    #else
-    p.replace(FPSTR(T_1),WiFi.hostname());
-    #endif
-  }
-  else if(id==F("stamac")){
-    p = FPSTR(HTTP_INFO_stamac);
-    p.replace(FPSTR(T_1),WiFi.macAddress());
-  }
-  else if(id==F("conx")){
-    p = FPSTR(HTTP_INFO_conx);
-    p.replace(FPSTR(T_1),WiFi.isConnected() ? FPSTR(S_y) : FPSTR(S_n));
-  }
-  #ifdef ESP8266
-  else if(id==F("autoconx")){
-    p = FPSTR(HTTP_INFO_autoconx);
-    p.replace(FPSTR(T_1),WiFi.getAutoConnect() ? FPSTR(S_enable) : FPSTR(S_disable));
-  }
-  #endif
-  #if defined(ESP32) && !defined(WM_NOTEMP)
-  else if(id==F("temp")){
-    // temperature is not calibrated, varying large offsets are present, use for relative temp changes only
-    p = FPSTR(HTTP_INFO_temp);
-    p.replace(FPSTR(T_1),(String)temperatureRead());
-    p.replace(FPSTR(T_2),(String)((temperatureRead()+32)*1.8f));
-  }
-  // else if(id==F("hall")){ 
-  //   p = FPSTR(HTTP_INFO_hall);
-  //   p.replace(FPSTR(T_1),(String)hallRead()); // hall sensor reads can cause issues with adcs
-  // }
+/** 
+ * HTTPD CALLBACK info page
+ * streamed chunked through a WM_INFO_BUFSIZE buffer, rows come from _infoFields
+ */
+void WiFiManager::handleInfo() {
+  #ifdef WM_DEBUG_LEVEL
+  DEBUG_WM(WM_DEBUG_VERBOSE,F("<- HTTP Info"));
   #endif
-  else if(id==F("aboutver")){
-    p = FPSTR(HTTP_INFO_aboutver);
-    p.replace(FPSTR(T_1),FPSTR(WM_VERSION_STR));
-  }
-  else if(id==F("aboutarduinover")){
-    #ifdef VER_ARDUINO_STR
-    p = FPSTR(HTTP_INFO_aboutarduino);
-    p.replace(FPSTR(T_1),String(VER_ARDUINO_STR));
-    #endif
-  }
-  // else if(id==F("aboutidfver")){
-  //   #ifdef VER_IDF_STR
-  //   p = FPSTR(HTTP_INFO_aboutidf);
-  //   p.replace(FPSTR(T_1),String(VER_IDF_STR));
-  //   #endif
-  // }
-  else if(id==F("aboutsdkver")){
-    p = FPSTR(HTTP_INFO_sdkver);
-    #ifdef ESP32
-      p.replace(FPSTR(T_1),(String)esp_get_idf_version());
-      // p.replace(FPSTR(T_1),(String)system_get_sdk_version()); // deprecated
-    #else
-    p.replace(FPSTR(T_1),(String)system_get_sdk_version());
-    #endif
+  handleRequest();
+  String page = getHTTPHead(FPSTR(S_titleinfo)); // @token titleinfo
+  reportStatus(page);
+
+  static_assert(sizeof(_infoFields) / sizeof(_infoFields[0]) == WM_INFO_MAX, "_infoFields out of step with wm_info_t");
+  if(!_infoCache) _infoCache.reset(new String[WM_INFO_MAX]);
+
+  server->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server->send(200, FPSTR(HTTP_HEAD_CT), "");
+  WMChunkOut out(*server);
+  out.add(page);
+  page = String(); // free the head before the rows
+
+  for(uint8_t i = 0; i < WM_INFO_MAX; i++){
+    if(i == WM_INFO_ABOUTVER) out.add_P(PSTR("</dl><h3>About</h3><hr><dl>"));
+    const wm_infofield_t &field = _infoFields[i];
+    String &row = _infoCache[i];
+    if(field.cached && row.length()){
+      out.add(row);
+      continue;
+    }
+    String v1, v2;
+    field.values(*this, v1, v2);
+    if(field.cached){
+      WMStringOut str{row};
+      infoFill(str, field.tpl, v1, v2);
+      out.add(row);
+    }
+    else infoFill(out, field.tpl, v1, v2);
   }
-  else if(id==F("aboutdate")){
-    p = FPSTR(HTTP_INFO_aboutdate);
-    p.replace(FPSTR(T_1),String(__DATE__ " " __TIME__));
+  out.add_P(PSTR("</dl>"));
+
+  if(_showInfoUpdate){
+    out.add_P(HTTP_PORTAL_MENU[8]);
+    out.add_P(HTTP_PORTAL_MENU[9]);
   }
-  return p;
+  if(_showInfoErase) out.add_P(HTTP_ERASEBTN);
+  if(_showBack) out.add_P(HTTP_BACKBTN);
+  out.add_P(HTTP_HELP);
+  out.add_P(HTTP_END);
+  out.flush();
+  server->sendContent(""); // last chunk
+
+  #ifdef WM_DEBUG_LEVEL
+  DEBUG_WM(WM_DEBUG_DEV,F("Sent info page"));
+  #endif
 }
 
 /** 
@@ -2345,7 +2614,7 @@ void WiFiManager::handleReset() {
   HTTPSend(page);
 
   #ifdef WM_DEBUG_LEVEL
-  DEBUG_WM(F("RESETTING ESP"));
+  DEBUG_WM(WM_DEBUG_NOTIFY,F("RESETTING ESP"));
   #endif
   delay(1000);
   reboot();
@@ -2381,7 +2650,7 @@ void WiFiManager::handleErase(boolean opt) {
   if(ret){
     delay(2000);
     #ifdef WM_DEBUG_LEVEL
-  	DEBUG_WM(F("RESETTING ESP"));
+  	DEBUG_WM(WM_DEBUG_NOTIFY,F("RESETTING ESP"));
     #endif
   	reboot();
   }	
@@ -2424,37 +2693,52 @@ boolean WiFiManager::captivePortal() {
   
   if(!_enableCaptivePortal || !configPortalActive) return false; // skip redirections if cp not enabled or not in ap mode
   
-  String serverLoc =  toStringIp(server->client().localIP());
-
-  #ifdef WM_DEBUG_LEVEL
-  DEBUG_WM(WM_DEBUG_DEV,"-> " + server->hostHeader());
-  DEBUG_WM(WM_DEBUG_DEV,"serverLoc " + serverLoc);
-  #endif
+  uint32_t ip = server->client().localIP();
 
   // fallback for ipv6 bug
-  if(serverLoc == "0.0.0.0"){
+  if(ip == 0){
     if ((WiFi.status()) != WL_CONNECTED)
-      serverLoc = toStringIp(WiFi.softAPIP());
+      ip = WiFi.softAPIP();
     else
-      serverLoc = toStringIp(WiFi.localIP());
+      ip = WiFi.localIP();
   }
-  
-  if(_httpPort != 80) serverLoc += ":" + (String)_httpPort; // add port if not default
-  bool doredirect = serverLoc != server->hostHeader(); // redirect if hostheader not server ip, prevent redirect loops
+  if(ip != _serverLocIp) setServerLoc(ip); // ap or sta ip changed, or the other interface
+
+  // redirect if hostheader not server ip, prevent redirect loops
+  const String &host = server->hostHeaderRef();
+  bool doredirect = host.length() != _serverLocLen || memcmp(host.c_str(), _serverLoc, _serverLocLen) != 0;
+
+  #ifdef WM_DEBUG_LEVEL
+  DEBUG_WM(WM_DEBUG_DEV,"-> " + host);
+  DEBUG_WM(WM_DEBUG_DEV,F("serverLoc "),_serverLoc);
+  #endif
   
   if (doredirect) {
     #ifdef WM_DEBUG_LEVEL
     DEBUG_WM(WM_DEBUG_VERBOSE,F("<- Request redirected to captive portal"));
-    DEBUG_WM(WM_DEBUG_DEV,"serverLoc " + serverLoc);
     #endif
-    server->sendHeader(F("Location"), (String)F("http://") + serverLoc, true); // @HTTPHEAD send redirect
-    server->send ( 302, FPSTR(HTTP_HEAD_CT2), ""); // Empty content inhibits Content-length header so we have to close the socket ourselves.
-    server->client().stop(); // Stop is needed because we sent no content length
+    server->client().write((const uint8_t*)_redirect, _redirectLen); // @HTTPHEAD send redirect
+    server->client().stop(); // close like before, clients re-request the portal on a fresh connection
     return true;
   }
   return false;
 }
 
+/**
+ * builds the host the portal is reached at on ip and the 302 to it, once per ip instead of per request
+ * @param uint32_t ip local ip of the interface the request came in on
+ */
+void WiFiManager::setServerLoc(uint32_t ip){
+  const uint8_t *b = (const uint8_t*)&ip;
+  int len = snprintf(_serverLoc, sizeof(_serverLoc), "%u.%u.%u.%u", b[0], b[1], b[2], b[3]);
+  if(_httpPort != 80) len += snprintf(_serverLoc + len, sizeof(_serverLoc) - len, ":%u", _httpPort); // add port if not default
+  _serverLocLen = len;
+  _redirectLen  = snprintf(_redirect, sizeof(_redirect),
+    "HTTP/1.1 302 Found\r\nLocation: http://%s\r\nContent-Type: %s\r\nContent-Length: 0\r\nConnection: close\r\n\r\n",
+    _serverLoc, String(FPSTR(HTTP_HEAD_CT2)).c_str());
+  _serverLocIp  = ip;
+}
+
 void WiFiManager::stopCaptivePortal(){
   _enableCaptivePortal= false;
   // @todo maybe disable configportaltimeout(optional), or just provide callback for user
@@ -2527,6 +2811,7 @@ void WiFiManager::reportStatus(String &page){
  * @return {[type]} [description]
  */
 bool WiFiManager::stopConfigPortal(){
+  WMPortalLock lock(this);
   if(_configPortalIsBlocking){
     abort = true;
     return true;
@@ -2548,7 +2833,7 @@ bool WiFiManager::disconnect(){
     return false;
   }  
   #ifdef WM_DEBUG_LEVEL
-  DEBUG_WM(F("Disconnecting"));
+  DEBUG_WM(WM_DEBUG_NOTIFY,F("Disconnecting"));
   #endif
   return WiFi_Disconnect();
 }
@@ -2559,7 +2844,7 @@ bool WiFiManager::disconnect(){
  */
 void WiFiManager::reboot(){
   #ifdef WM_DEBUG_LEVEL
-  DEBUG_WM(F("Restarting"));
+  DEBUG_WM(WM_DEBUG_NOTIFY,F("Restarting"));
   #endif
   ESP.restart();
 }
@@ -2574,14 +2859,14 @@ bool WiFiManager::erase(){
 
 bool WiFiManager::erase(bool opt){
   #ifdef WM_DEBUG_LEVEL
-  DEBUG_WM("Erasing");
+  DEBUG_WM(WM_DEBUG_NOTIFY,"Erasing");
   #endif
 
   #if defined(ESP32) && ((defined(WM_ERASE_NVS) || defined(nvs_flash_h)))
     // if opt true, do nvs erase
     if(opt){
       #ifdef WM_DEBUG_LEVEL
-      DEBUG_WM(F("Erasing NVS"));
+      DEBUG_WM(WM_DEBUG_NOTIFY,F("Erasing NVS"));
       #endif
       esp_err_t err;
       err = nvs_flash_init();
@@ -2599,7 +2884,7 @@ bool WiFiManager::erase(bool opt){
       bool ret = false;
       if(SPIFFS.begin()){
       #ifdef WM_DEBUG_LEVEL
-        DEBUG_WM(F("Erasing SPIFFS"));
+        DEBUG_WM(WM_DEBUG_NOTIFY,F("Erasing SPIFFS"));
         #endif
         bool ret = SPIFFS.format();
         #ifdef WM_DEBUG_LEVEL
@@ -2607,7 +2892,7 @@ bool WiFiManager::erase(bool opt){
         #endif
       } else{
       #ifdef WM_DEBUG_LEVEL
-        DEBUG_WM(F("[ERROR] Could not start SPIFFS"));
+        DEBUG_WM(WM_DEBUG_NOTIFY,F("[ERROR] Could not start SPIFFS"));
         #endif
       }
       return ret;
@@ -2617,7 +2902,7 @@ bool WiFiManager::erase(bool opt){
   #endif
 
   #ifdef WM_DEBUG_LEVEL
-  DEBUG_WM(F("Erasing WiFi Config"));
+  DEBUG_WM(WM_DEBUG_NOTIFY,F("Erasing WiFi Config"));
   #endif
   return WiFi_eraseConfig();
 }
@@ -2629,7 +2914,7 @@ bool WiFiManager::erase(bool opt){
  */
 void WiFiManager::resetSettings() {
 #ifdef WM_DEBUG_LEVEL
-  DEBUG_WM(F("resetSettings"));
+  DEBUG_WM(WM_DEBUG_NOTIFY,F("resetSettings"));
   #endif
   WiFi_enableSTA(true,true); // must be sta to disconnect erase
   delay(500); // ensure sta is enabled
@@ -2637,6 +2922,9 @@ void WiFiManager::resetSettings() {
       _resetcallback();  // @CALLBACK
   }
   
+  #ifdef WM_CRED_STORE
+    creds().clear();
+  #endif
   #ifdef ESP32
     WiFi.disconnect(true,true);
   #else
@@ -2645,7 +2933,7 @@ void WiFiManager::resetSettings() {
     WiFi.persistent(false);
   #endif
   #ifdef WM_DEBUG_LEVEL
-  DEBUG_WM(F("SETTINGS ERASED"));
+  DEBUG_WM(WM_DEBUG_NOTIFY,F("SETTINGS ERASED"));
   #endif
 }
 
@@ -2722,7 +3010,7 @@ void WiFiManager::setSaveConnect(bool connect) {
 void WiFiManager::setDebugOutput(boolean debug) {
   _debug = debug;
   if(_debug && _debugLevel == WM_DEBUG_DEV) debugPlatformInfo();
-  if(_debug && _debugLevel >= WM_DEBUG_NOTIFY)DEBUG_WM((__FlashStringHelper *)WM_VERSION_STR," D:"+String(_debugLevel));
+  DEBUG_WM(WM_DEBUG_NOTIFY,(__FlashStringHelper *)WM_VERSION_STR," D:"+String(_debugLevel));
 }
 
 void WiFiManager::setDebugOutput(boolean debug, String prefix) {
@@ -2870,6 +3158,26 @@ void WiFiManager::setPreOtaUpdateCallback( std::function<void()> func ) {
   _preotaupdatecallback = func;
 }
 
+/**
+ * setOtaProgressCallback, set a callback to fire as OTA data is flashed
+ * with the pipeline it runs on the writer task, keep it short and thread safe
+ * @access public
+ * @param {[type]} void (*func)(uint32_t done, uint32_t total)
+ */
+void WiFiManager::setOtaProgressCallback( std::function<void(uint32_t done, uint32_t total)> func ) {
+  _otaprogresscallback = func;
+}
+
+/**
+ * setOtaFailCallback, set a callback to fire when an OTA upload failed or was aborted
+ * a successful one restarts instead
+ * @access public
+ * @param {[type]} void (*func)(void)
+ */
+void WiFiManager::setOtaFailCallback( std::function<void()> func ) {
+  _otafailcallback = func;
+}
+
 /**
  * setConfigPortalTimeoutCallback, set a callback to config portal is timeout
  * @access public
@@ -2933,7 +3241,7 @@ void WiFiManager::setRestorePersistent(boolean persistent) {
   _userpersistent = persistent;
   if(!persistent){
     #ifdef WM_DEBUG_LEVEL
-    DEBUG_WM(F("persistent is off"));
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("persistent is off"));
     #endif
   }
 }
@@ -3123,6 +3431,119 @@ bool WiFiManager::getWebPortalActive(){
   return webPortalActive;
 }
 
+#ifdef WM_PORTAL_TASK
+/**
+ * startPortalTask, serve non blocking portals from a task of their own
+ * the task sleeps until a portal starts, then in select() on the portal sockets between requests,
+ * so an idle portal costs no cpu and the caller never has to poll process()
+ * @access public
+ * @param  {UBaseType_t} priority
+ * @return {bool} task running
+ */
+bool WiFiManager::startPortalTask(UBaseType_t priority){
+  if(_portalTask) return true;
+  if(!_portalLock) _portalLock = xSemaphoreCreateRecursiveMutex();
+  if(!_portalLock || xTaskCreate(portalTaskLoop, "wm_portal", WM_PORTAL_TASK_STACK, this, priority, &_portalTask) != pdPASS){
+    #ifdef WM_DEBUG_LEVEL
+    DEBUG_WM(WM_DEBUG_ERROR,F("[ERROR] portal task start failed"));
+    #endif
+    _portalTask = NULL;
+    return false;
+  }
+  if(portalRunning()) xTaskNotifyGive(_portalTask); // already started
+  return true;
+}
+
+TaskHandle_t WiFiManager::getPortalTask(){
+  return _portalTask;
+}
+
+bool WiFiManager::portalRunning(){
+  return webPortalActive || (configPortalActive && !_configPortalIsBlocking);
+}
+
+/**
+ * collects the portal sockets to wait on, the listener, the dns socket and the open client
+ * @param  {fd_set} rd  set to fill
+ * @param  {uint32_t} ms  wait, shortened while a client is open
+ * @return {int} highest fd, -1 if there is nothing to wait on
+ */
+int WiFiManager::portalFds(fd_set &rd, uint32_t &ms){
+  FD_ZERO(&rd);
+  int fds[3] = {
+    server ? _httpFd : -1,
+    configPortalActive && dnsServer ? _dnsFd : -1,
+    server ? server->client().fd() : -1
+  };
+  if(server && _httpFd < 0) return -1; // not found, caller polls
+  if(fds[2] >= 0) ms = std::min(ms, (uint32_t)WM_PORTAL_POLL_MS);
+  int maxfd = -1;
+  for(int fd : fds){
+    if(fd < 0) continue;
+    FD_SET(fd, &rd);
+    maxfd = std::max(maxfd, fd);
+  }
+  return maxfd;
+}
+
+// sleeps until a portal socket is readable or ms passed
+void WiFiManager::waitPortalEvent(uint32_t ms){
+  fd_set rd;
+  int maxfd = portalFds(rd, ms);
+  portalSelect(rd, maxfd, ms);
+}
+
+void WiFiManager::portalSelect(fd_set &rd, int maxfd, uint32_t ms){
+  if(maxfd < 0){
+    delay(WM_PORTAL_POLL_MS); // no sockets, poll like before but without spinning
+    return;
+  }
+  struct timeval tv = { (time_t)(ms / 1000), (suseconds_t)((ms % 1000) * 1000) };
+  select(maxfd + 1, &rd, NULL, NULL, &tv);
+}
+
+// the servers keep their sockets private, find them by what they are bound to
+int WiFiManager::findSocket(int type, uint16_t port){
+  for(int fd = LWIP_SOCKET_OFFSET; fd < LWIP_SOCKET_OFFSET + CONFIG_LWIP_MAX_SOCKETS; fd++){
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    int val = 0;
+    socklen_t vlen = sizeof(val);
+    if(getsockname(fd, (struct sockaddr*)&addr, &len) != 0 || addr.sin_family != AF_INET || ntohs(addr.sin_port) != port) continue;
+    if(getsockopt(fd, SOL_SOCKET, SO_TYPE, &val, &vlen) != 0 || val != type) continue;
+    if(type == SOCK_STREAM && (getsockopt(fd, SOL_SOCKET, SO_ACCEPTCONN, &val, &vlen) != 0 || !val)) continue; // skip clients
+    return fd;
+  }
+  #ifdef WM_DEBUG_LEVEL
+  DEBUG_WM(WM_DEBUG_DEV,F("portal socket not found, port"),port);
+  #endif
+  return -1;
+}
+
+void WiFiManager::portalTaskLoop(void *arg){
+  WiFiManager *wm = (WiFiManager*)arg;
+  while(true){
+    fd_set rd;
+    uint32_t ms = WM_PORTAL_IDLE_MS;
+    int maxfd = -1;
+    bool running;
+    {
+      WMPortalLock lock(wm);
+      running = wm->portalRunning();
+      if(running) maxfd = wm->portalFds(rd, ms);
+    }
+    if(!running){
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // no portal, wait for a start
+      continue;
+    }
+    // wait outside the lock, stopping the portal closes the sockets and wakes select
+    wm->portalSelect(rd, maxfd, ms);
+    WMPortalLock lock(wm);
+    if(wm->portalRunning()) wm->process();
+  }
+}
+#endif
+
 
 String WiFiManager::getWiFiHostname(){
   #ifdef ESP32
@@ -3233,6 +3654,123 @@ uint8_t WiFiManager::getLastConxResult(){
   return _lastconxresult;
 }
 
+#ifdef WM_CONNECT_EVENTS
+/**
+ * connectAsync, start a connect and return, see the header for when done runs
+ * @since $dev
+ * @access public
+ * @param  {function} done     void(uint8_t status, uint8_t reason)
+ * @param  {uint32_t} timeout  ms, 0 for the connect timeout or 60s
+ * @param  {String}   ssid     empty for saved credentials
+ * @param  {String}   pass
+ * @param  {bool}     persist  false to save ssid only once it connected
+ * @return {bool} started, false if another connect is pending or nothing is saved
+ */
+bool WiFiManager::connectAsync(std::function<void(uint8_t status, uint8_t reason)> done, uint32_t timeout, String ssid, String pass, bool persist){
+  if(_connectPending) return false;
+  _begin();
+  if(ssid == "" && WiFi.status() == WL_CONNECTED){
+    if(done) done(WL_CONNECTED, 0);
+    return true;
+  }
+  if(ssid == "" && !WiFi_hasAutoConnect()){
+    #ifdef WM_DEBUG_LEVEL
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("No wifi saved, skipping"));
+    #endif
+    return false;
+  }
+  WiFi_autoReconnect(); // registers WiFiEvent
+  if(!_connectTimer){
+    esp_timer_create_args_t args = {};
+    args.callback = connectTimeout;
+    args.arg      = this;
+    args.name     = "wm_connect";
+    if(esp_timer_create(&args, &_connectTimer) != ESP_OK) return false;
+  }
+  if(timeout == 0) timeout = _connectTimeout ? _connectTimeout : WM_CONNECT_DEFAULT_MS;
+  _connectDone    = done;
+  #ifdef WM_CRED_STORE
+  _connectSSID    = ssid != "" ? ssid : WiFi_SSID(true);
+  _connectPass    = ssid != "" ? pass : WiFi_psk(true);
+  _connectStart   = millis();
+  #endif
+  _connectPersist = persist || ssid == "";
+  _connectPending = true;
+  esp_timer_start_once(_connectTimer, (uint64_t)timeout * 1000);
+
+  setSTAConfig();
+  if(ssid != "") wifiConnectNew(ssid, pass, true, persist);
+  else {
+    // wifiConnectDefault() without its settle delay, the events tell when it is done
+    connectBegin();
+    WiFi_enableSTA(true,storeSTAmode);
+    #ifdef WM_DEBUG_LEVEL
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("Connecting to SAVED AP:"),WiFi_SSID(true));
+    #endif
+    WiFi.begin();
+  }
+  return true;
+}
+
+bool WiFiManager::connectPending(){
+  return _connectPending;
+}
+
+/**
+ * scanAsync, start a scan and return, done runs once the snapshot holds its result
+ * @since $dev
+ * @access public
+ * @param  {function} done  void(), on the wifi event task, also after a failed scan
+ * @return {bool} started, false if a scan is already running or could not start
+ */
+bool WiFiManager::scanAsync(std::function<void()> done){
+  if(_scanDone) return false;
+  _begin();
+  WiFi_autoReconnect(); // registers WiFiEvent
+  WiFi_enableSTA(true);
+  _scanDone  = done;
+  _startscan = millis();
+  #ifdef WM_DEBUG_LEVEL
+  DEBUG_WM(WM_DEBUG_VERBOSE,F("WiFi Scan ASYNC started"));
+  #endif
+  if(WiFi.scanNetworks(true) != WIFI_SCAN_RUNNING){
+    _scanDone = nullptr;
+    return false;
+  }
+  return true;
+}
+
+uint8_t WiFiManager::getLastDisconnectReason(){
+  return _disconnectReason;
+}
+
+// clears the result of the previous attempt, call before each begin()
+void WiFiManager::connectBegin(){
+  if(!_connectEvents) _connectEvents = xEventGroupCreate();
+  if(_connectEvents) xEventGroupClearBits(_connectEvents, WM_CONN_GOTIP | WM_CONN_FAILED);
+}
+
+// ends a pending connectAsync, only the first of event and timeout gets through
+void WiFiManager::connectFinish(uint8_t status){
+  if(!_connectPending.exchange(false)) return;
+  esp_timer_stop(_connectTimer);
+  _lastconxresult = status;
+  #ifdef WM_CRED_STORE
+  // connect history, like connectWifi, the resyncs are most of the connects
+  if(status == WL_CONNECTED) creds().success(_connectSSID.c_str(), _connectPass.c_str(), millis()-_connectStart);
+  else creds().failure(_connectSSID.c_str());
+  #endif
+  if(status == WL_CONNECTED && !_connectPersist) WiFi_saveSTAConfig();
+  std::function<void(uint8_t,uint8_t)> done = _connectDone; // done may start the next connect
+  if(done) done(status, status == WL_CONNECTED ? 0 : _disconnectReason);
+}
+
+void WiFiManager::connectTimeout(void *arg){
+  WiFiManager *wm = (WiFiManager*)arg;
+  wm->connectFinish(WiFi.status());
+}
+#endif
+
 /**
  * check if wifi has a saved ap or not
  * @since $dev
@@ -3319,27 +3857,18 @@ String WiFiManager::getWiFiPass(bool persistent){
 } 
 
 // DEBUG
-// @todo fix DEBUG_WM(0,0);
-template <typename Generic>
-void WiFiManager::DEBUG_WM(Generic text) {
-  DEBUG_WM(WM_DEBUG_NOTIFY,text,"");
-}
-
+// call through the DEBUG_WM(level,...) macro, it filters by level before any argument is built
 template <typename Generic>
-void WiFiManager::DEBUG_WM(wm_debuglevel_t level,Generic text) {
-  if(_debugLevel >= level) DEBUG_WM(level,text,"");
-}
-
-template <typename Generic, typename Genericb>
-void WiFiManager::DEBUG_WM(Generic text,Genericb textb) {
-  DEBUG_WM(WM_DEBUG_NOTIFY,text,textb);
+void WiFiManager::debugWM(wm_debuglevel_t level,Generic text) {
+  debugWM(level,text,"");
 }
 
 template <typename Generic, typename Genericb>
-void WiFiManager::DEBUG_WM(wm_debuglevel_t level,Generic text,Genericb textb) {
+void WiFiManager::debugWM(wm_debuglevel_t level,Generic text,Genericb textb) {
   if(!_debug || _debugLevel < level) return;
 
-  if(_debugLevel >= WM_DEBUG_MAX){
+  #if WM_DEBUG_COMPILE_LEVEL > 5 // WM_DEBUG_MAX
+  if(_debugLevel > WM_DEBUG_MAX){
     #ifdef ESP8266
     // uint32_t free;
     // uint16_t max;
@@ -3362,6 +3891,7 @@ void WiFiManager::DEBUG_WM(wm_debuglevel_t level,Generic text,Genericb textb) {
     _debugPort.printf("[MEM] free: %5d | max: %5d | frag: %3d%% \n", free, max, frag);    
     #endif
   }
+  #endif
 
   _debugPort.print(_debugPrefix);
   if(_debugLevel >= debugLvlShow) _debugPort.print("["+(String)level+"] ");
@@ -3373,6 +3903,58 @@ void WiFiManager::DEBUG_WM(wm_debuglevel_t level,Generic text,Genericb textb) {
   _debugPort.println();
 }
 
+#ifdef WM_DEBUG_RINGSIZE
+/**
+ * append a binary record to the debug ring, cheap enough for event callbacks
+ * @param level debug level of the record
+ * @param fmt   format id, WM_LOG_FMT index
+ * @param a     first format arg
+ * @param b     second format arg
+ */
+void WiFiManager::logWM(wm_debuglevel_t level, wm_logfmt_t fmt, int32_t a, int32_t b) {
+  #ifdef ESP32
+  portENTER_CRITICAL(&_logMux);
+  #endif
+  wm_logrec_t &rec = _logRing[_logHead];
+  rec.ms    = millis();
+  rec.level = level;
+  rec.fmt   = fmt;
+  rec.a     = a;
+  rec.b     = b;
+  _logHead  = (_logHead + 1) % WM_DEBUG_RINGSIZE;
+  _logCount++;
+  #ifdef ESP32
+  portEXIT_CRITICAL(&_logMux);
+  #endif
+}
+
+/**
+ * format the debug ring, oldest first
+ * @access public
+ * @param out print target, Serial or a StreamString for http
+ */
+void WiFiManager::dumpDebugLog(Print &out) {
+  uint32_t count = _logCount < WM_DEBUG_RINGSIZE ? _logCount : WM_DEBUG_RINGSIZE;
+  uint16_t idx   = (_logHead + WM_DEBUG_RINGSIZE - count) % WM_DEBUG_RINGSIZE;
+  char line[64];
+  out.print(_debugPrefix);
+  out.printf(" log %lu of %lu records\n", (unsigned long)count, (unsigned long)_logCount);
+  for(uint32_t i = 0; i < count; i++){
+    wm_logrec_t rec;
+    #ifdef ESP32
+    portENTER_CRITICAL(&_logMux);
+    #endif
+    rec = _logRing[(idx + i) % WM_DEBUG_RINGSIZE];
+    #ifdef ESP32
+    portEXIT_CRITICAL(&_logMux);
+    #endif
+    snprintf_P(line, sizeof(line), WM_LOG_FMT[rec.fmt], (int)rec.a, (int)rec.b);
+    out.printf("%10lu [%u] ", (unsigned long)rec.ms, rec.level);
+    out.println(line);
+  }
+}
+#endif
+
 /**
  * [debugSoftAPConfig description]
  * @access public
@@ -3396,22 +3978,22 @@ void WiFiManager::debugSoftAPConfig(){
     #endif
 
     #ifdef WM_DEBUG_LEVEL
-    DEBUG_WM(F("SoftAP Configuration"));
-    DEBUG_WM(FPSTR(D_HR));
-    DEBUG_WM(F("ssid:            "),(char *) config.ssid);
-    DEBUG_WM(F("password:        "),(char *) config.password);
-    DEBUG_WM(F("ssid_len:        "),config.ssid_len);
-    DEBUG_WM(F("channel:         "),config.channel);
-    DEBUG_WM(F("authmode:        "),config.authmode);
-    DEBUG_WM(F("ssid_hidden:     "),config.ssid_hidden);
-    DEBUG_WM(F("max_connection:  "),config.max_connection);
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("SoftAP Configuration"));
+    DEBUG_WM(WM_DEBUG_NOTIFY,FPSTR(D_HR));
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("ssid:            "),(char *) config.ssid);
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("password:        "),(char *) config.password);
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("ssid_len:        "),config.ssid_len);
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("channel:         "),config.channel);
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("authmode:        "),config.authmode);
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("ssid_hidden:     "),config.ssid_hidden);
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("max_connection:  "),config.max_connection);
     #endif
     #if !defined(WM_NOCOUNTRY) 
     #ifdef WM_DEBUG_LEVEL
-      DEBUG_WM(F("country:         "),(String)country.cc);
+      DEBUG_WM(WM_DEBUG_NOTIFY,F("country:         "),(String)country.cc);
       #endif
-    DEBUG_WM(F("beacon_interval: "),(String)config.beacon_interval + "(ms)");
-    DEBUG_WM(FPSTR(D_HR));
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("beacon_interval: "),(String)config.beacon_interval + "(ms)");
+    DEBUG_WM(WM_DEBUG_NOTIFY,FPSTR(D_HR));
     #endif
 }
 
@@ -3424,24 +4006,24 @@ void WiFiManager::debugPlatformInfo(){
   #ifdef ESP8266
     system_print_meminfo();
     #ifdef WM_DEBUG_LEVEL
-    DEBUG_WM(F("[SYS] getCoreVersion():         "),ESP.getCoreVersion());
-    DEBUG_WM(F("[SYS] system_get_sdk_version(): "),system_get_sdk_version());
-    DEBUG_WM(F("[SYS] system_get_boot_version():"),system_get_boot_version());
-    DEBUG_WM(F("[SYS] getFreeHeap():            "),(String)ESP.getFreeHeap());
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("[SYS] getCoreVersion():         "),ESP.getCoreVersion());
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("[SYS] system_get_sdk_version(): "),system_get_sdk_version());
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("[SYS] system_get_boot_version():"),system_get_boot_version());
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("[SYS] getFreeHeap():            "),(String)ESP.getFreeHeap());
     #endif
   #elif defined(ESP32)
   #ifdef WM_DEBUG_LEVEL
-    DEBUG_WM(F("[SYS] WM version: "),      WM_VERSION_STR);
-    DEBUG_WM(F("[SYS] Arduino version: "), VER_ARDUINO_STR);
-    DEBUG_WM(F("[SYS] ESP SDK version: "), ESP.getSdkVersion());
-    DEBUG_WM(F("[SYS] Free heap:       "), ESP.getFreeHeap());
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("[SYS] WM version: "),      WM_VERSION_STR);
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("[SYS] Arduino version: "), VER_ARDUINO_STR);
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("[SYS] ESP SDK version: "), ESP.getSdkVersion());
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("[SYS] Free heap:       "), ESP.getFreeHeap());
     #endif
 
     #ifdef WM_DEBUG_LEVEL
-    DEBUG_WM(F("[SYS] Chip ID:"),WIFI_getChipId());
-    DEBUG_WM(F("[SYS] Chip Model:"), ESP.getChipModel());
-    DEBUG_WM(F("[SYS] Chip Cores:"), ESP.getChipCores());
-    DEBUG_WM(F("[SYS] Chip Rev:"),   ESP.getChipRevision());
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("[SYS] Chip ID:"),WIFI_getChipId());
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("[SYS] Chip Model:"), ESP.getChipModel());
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("[SYS] Chip Cores:"), ESP.getChipCores());
+    DEBUG_WM(WM_DEBUG_NOTIFY,F("[SYS] Chip Rev:"),   ESP.getChipRevision());
     #endif
   #endif
 }
@@ -3480,13 +4062,23 @@ String WiFiManager::toStringIp(IPAddress ip) {
   return res;
 }
 
+/** FNV-1a string hash, used for ssid dedupe */
+uint32_t WiFiManager::hashStr(const char *str) {
+  uint32_t hash = 2166136261UL;
+  while(*str){
+    hash ^= (uint8_t)*str++;
+    hash *= 16777619UL;
+  }
+  return hash;
+}
+
 boolean WiFiManager::validApPassword(){
   // check that ap password is valid, return false
   if (_apPassword == NULL) _apPassword = "";
   if (_apPassword != "") {
     if (_apPassword.length() < 8 || _apPassword.length() > 63) {
     #ifdef WM_DEBUG_LEVEL
-      DEBUG_WM(F("AccessPoint set password is INVALID or <8 chars"));
+      DEBUG_WM(WM_DEBUG_NOTIFY,F("AccessPoint set password is INVALID or <8 chars"));
       #endif
       _apPassword = "";
       return false; // @todo FATAL or fallback to empty , currently fatal, fail secure.
@@ -3499,24 +4091,47 @@ boolean WiFiManager::validApPassword(){
   return true;
 }
 
+/**
+ * size of str once escaped, excluding null term
+ * @param  str        string to escape
+ * @param  ctx        WM_ESC_ATTR attribute value, WM_ESC_TEXT html text (spaces to nbsp)
+ * @return escaped length
+ */
+size_t WiFiManager::htmlEscapeLen(const char *str, wm_escape_t ctx){
+  return wmEscapeLen(str, ctx);
+}
+
+/**
+ * escape str into buf in one pass, never splits an entity
+ * @param  buf   output buffer, always null terminated
+ * @param  size  size of buf, htmlEscapeLen()+1 for no truncation
+ * @param  str   string to escape
+ * @param  ctx   WM_ESC_ATTR attribute value, WM_ESC_TEXT html text (spaces to nbsp)
+ * @return bytes written excluding null term
+ */
+size_t WiFiManager::htmlEscape(char *buf, size_t size, const char *str, wm_escape_t ctx){
+  return wmEscape(buf, size, str, ctx);
+}
+
 /**
  * encode htmlentities
  * @since $dev
  * @param  string str  string to replace entities
  * @return string      encoded string
  */
-String WiFiManager::htmlEntities(String str, bool whitespace) {
-  str.replace("&","&amp;");
-  str.replace("<","&lt;");
-  str.replace(">","&gt;");
-  str.replace("'","&#39;");
-  if(whitespace) str.replace(" ","&#160;");
-  // str.replace("-","&ndash;");
-  // str.replace("\"","&quot;");
-  // str.replace("/": "&#x2F;");
-  // str.replace("`": "&#x60;");
-  // str.replace("=": "&#x3D;");
-return str;
+String WiFiManager::htmlEntities(const String &str, bool whitespace) {
+  wm_escape_t ctx = whitespace ? WM_ESC_TEXT : WM_ESC_ATTR;
+  size_t len = htmlEscapeLen(str.c_str(), ctx);
+  if(len == str.length()) return str; // nothing to escape
+  char stackbuf[WM_ESCAPE_BUFSIZE];
+  std::unique_ptr<char[]> heapbuf;
+  char *buf = stackbuf;
+  if(len >= sizeof(stackbuf)){
+    heapbuf.reset(new char[len + 1]);
+    buf = heapbuf.get();
+  }
+  htmlEscape(buf, len + 1, str.c_str(), ctx);
+  return String(buf);
 }
 
 /**
@@ -3804,6 +4419,7 @@ String WiFiManager::WiFi_psk(bool persistent) const {
     #define wifi_sta_disconnected disconnected
     #define ARDUINO_EVENT_WIFI_STA_DISCONNECTED SYSTEM_EVENT_STA_DISCONNECTED
     #define ARDUINO_EVENT_WIFI_SCAN_DONE SYSTEM_EVENT_SCAN_DONE
+    #define ARDUINO_EVENT_WIFI_STA_GOT_IP SYSTEM_EVENT_STA_GOT_IP
   #endif
     if(!_hasBegun){
       #ifdef WM_DEBUG_LEVEL
@@ -3817,10 +4433,24 @@ String WiFiManager::WiFi_psk(bool persistent) const {
     #ifdef WM_DEBUG_LEVEL
     // DEBUG_WM(WM_DEBUG_VERBOSE,"[EVENT]",event);
     #endif
-    if(event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED){
+    if(event == ARDUINO_EVENT_WIFI_STA_GOT_IP){
+      #ifdef WM_CONNECT_EVENTS
+      if(_connectEvents) xEventGroupSetBits(_connectEvents, WM_CONN_GOTIP);
+      connectFinish(WL_CONNECTED);
+      #endif
+    }
+    else if(event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED){
     #ifdef WM_DEBUG_LEVEL
       DEBUG_WM(WM_DEBUG_VERBOSE,F("[EVENT] WIFI_REASON: "),info.wifi_sta_disconnected.reason);
       #endif
+      #ifdef WM_CONNECT_EVENTS
+      _disconnectReason = info.wifi_sta_disconnected.reason;
+      if(connectGaveUp(_disconnectReason)){
+        if(_connectEvents) xEventGroupSetBits(_connectEvents, WM_CONN_FAILED);
+        connectFinish(connectFailStatus(_disconnectReason));
+      }
+      #endif
+      LOG_WM(WM_DEBUG_VERBOSE,WM_LOG_DISCONNECT,info.wifi_sta_disconnected.reason);
       if(info.wifi_sta_disconnected.reason == WIFI_REASON_AUTH_EXPIRE || info.wifi_sta_disconnected.reason == WIFI_REASON_AUTH_FAIL){
         _lastconxresulttmp = 7; // hack in wrong password internally, sdk emit WIFI_REASON_AUTH_EXPIRE on some routers on auth_fail
       } else _lastconxresulttmp = WiFi.status();
@@ -3838,9 +4468,12 @@ String WiFiManager::WiFi_psk(bool persistent) const {
         WiFi.reconnect();
       #endif
   }
-  else if(event == ARDUINO_EVENT_WIFI_SCAN_DONE && _asyncScan){
-    uint16_t scans = WiFi.scanComplete();
+  else if(event == ARDUINO_EVENT_WIFI_SCAN_DONE && (_asyncScan || _scanDone)){
+    int16_t scans = WiFi.scanComplete(); // WIFI_SCAN_FAILED is negative
     WiFi_scanComplete(scans);
+    std::function<void()> done = _scanDone; // done may start the next scan
+    _scanDone = nullptr;
+    if(done) done();
   }
 }
 #endif
@@ -3887,7 +4520,7 @@ void WiFiManager::handleUpdating(){
   // add upload status to webpage somehow
   // abort upload if error detected ?
   // [x] supress cp timeout on upload, so it doesnt keep uploading?
-  // add progress handler for debugging
+  // [x] add progress handler for debugging
   // combine route handlers into one callback and use argument or post checking instead of mutiple functions maybe, if POST process else server upload page?
   // [x] add upload checking, do we need too check file?
   // convert output to debugger if not moving to example
@@ -3929,6 +4562,12 @@ void WiFiManager::handleUpdating(){
     //       Serial.printf("Progress: %u%%\r", (progress / (total / 100)));
     // });
 
+    _otaWritten = 0;
+    _otaTotal   = server->clientContentLength(); // includes the multipart framing
+    #ifdef WM_OTA_DELTA
+    _otaFirst    = true;
+    _otaDeltaErr = WM_DELTA_OK;
+    #endif
   	if (!Update.begin(maxSketchSpace)) { // start with max available size
         #ifdef WM_DEBUG_LEVEL
         DEBUG_WM(WM_DEBUG_ERROR,F("[ERROR] OTA Update ERROR"), Update.getError());
@@ -3936,21 +4575,66 @@ void WiFiManager::handleUpdating(){
         error = true;
         Update.end(); // Not sure the best way to abort, I think client will keep sending..
   	}
+    else {
+      #ifdef ESP32
+      // optional /u?md5=<hex>, the hash is updated as blocks are written and checked by end()
+      if (server->hasArg(F("md5"))) Update.setMD5(server->arg(F("md5")).c_str());
+      #endif
+      #ifdef WM_OTA_PIPELINE
+      if (!otaPipeStart()) {
+        #ifdef WM_DEBUG_LEVEL
+        DEBUG_WM(WM_DEBUG_ERROR,F("[ERROR] OTA pipeline alloc failed"));
+        #endif
+        error = true;
+        Update.abort();
+      }
+      #endif
+    }
 	}
   // UPLOAD WRITE
   else if (upload.status == UPLOAD_FILE_WRITE) {
 		// Serial.print(".");
-		if (Update.write(upload.buf, upload.currentSize) != upload.currentSize) {
+    #ifdef WM_OTA_DELTA
+    if (_otaFirst) {
+      _otaFirst = false;
+      if (!otaDeltaStart(upload.buf, upload.currentSize)) error = true;
+    }
+    #endif
+    #ifdef WM_OTA_PIPELINE
+    // only copies, the writer task flashes full sectors while the next chunk is received
+    if (_otaQueue == NULL || _otaError) error = true;
+    else otaPipeWrite(upload.buf, upload.currentSize);
+    #else
+		if (!otaWrite(upload.buf, upload.currentSize)) {
       #ifdef WM_DEBUG_LEVEL
       DEBUG_WM(WM_DEBUG_ERROR,F("[ERROR] OTA Update WRITE ERROR"), Update.getError());
 			//Update.printError(Serial); // write failure
       #endif
       error = true;
 		}
+    else otaProgress(upload.currentSize);
+    #endif
 	}
   // UPLOAD FILE END
   else if (upload.status == UPLOAD_FILE_END) {
-		if (Update.end(true)) { // true to set the size to the current progress
+    #ifdef WM_OTA_PIPELINE
+    if (!otaPipeFinish(false)) {
+      #ifdef WM_DEBUG_LEVEL
+      DEBUG_WM(WM_DEBUG_ERROR,F("[ERROR] OTA Update WRITE ERROR"), Update.getError());
+      #endif
+      error = true;
+    }
+    #endif
+    #ifdef WM_OTA_DELTA
+    if (otaDeltaEnd(error) != WM_DELTA_OK) {
+      #ifdef WM_DEBUG_LEVEL
+      DEBUG_WM(WM_DEBUG_ERROR,F("[ERROR] OTA delta patch"), WMDelta::errorString(_otaDeltaErr));
+      #endif
+      error = true;
+    }
+    #endif
+    LOG_WM(WM_DEBUG_NOTIFY,WM_LOG_OTA,upload.totalSize,Update.getError());
+		if (!error && Update.end(true)) { // true to set the size to the current progress
       #ifdef WM_DEBUG_LEVEL
       DEBUG_WM(WM_DEBUG_VERBOSE,F("\n\n[OTA] OTA FILE END bytes: "), upload.totalSize);
 			// Serial.printf("Updated: %u bytes\r\nRebooting...\r\n", upload.totalSize);
@@ -3959,18 +4643,178 @@ void WiFiManager::handleUpdating(){
     else {
 			// Update.printError(Serial);
       error = true;
+      #ifdef ESP32
+      // a writer or patch error leaves it running and every later begin() would fail until a
+      // reboot, a failed end() already reset it and keeps its own error for the done page
+      if (Update.isRunning()) Update.abort();
+      #endif
 		}
 	}
   // UPLOAD ABORT
   else if (upload.status == UPLOAD_FILE_ABORTED) {
+    #ifdef WM_OTA_PIPELINE
+    otaPipeFinish(true);
+    #endif
+    #ifdef WM_OTA_DELTA
+    otaDeltaEnd(true);
+    #endif
 		Update.end();
-		DEBUG_WM(F("[OTA] Update was aborted"));
+		DEBUG_WM(WM_DEBUG_NOTIFY,F("[OTA] Update was aborted"));
     error = true;
   }
   if(error) _configPortalTimeout = _configPortalTimeoutSAV;
+  // a good upload reboots, a failed one tells the sketch it is over
+  if(error && (upload.status == UPLOAD_FILE_END || upload.status == UPLOAD_FILE_ABORTED) && _otafailcallback != NULL) {
+    _otafailcallback();  // @CALLBACK
+  }
 	delay(0);
 }
 
+// flashes upload data, or decodes it first when it is a patch
+bool WiFiManager::otaWrite(uint8_t *data, size_t len){
+  #ifdef WM_OTA_DELTA
+  if (_otaDelta) return _otaDelta->feed(data, len) == WM_DELTA_OK;
+  #endif
+  return Update.write(data, len) == len;
+}
+
+void WiFiManager::otaProgress(uint32_t done){
+  _otaWritten += done;
+  if (_otaprogresscallback != NULL) {
+    _otaprogresscallback(_otaWritten, _otaTotal);  // @CALLBACK
+  }
+}
+
+#ifdef WM_OTA_PIPELINE
+/**
+ * ota pipeline, the upload handler copies into one sector buffer while the writer task erases
+ * and flashes the other. Update is only touched by the writer between start and finish, and
+ * buffers always go to the writer in order, so the free one is always the other one.
+ */
+bool WiFiManager::otaPipeStart(){
+  _otaBuf[0] = (uint8_t*)malloc(WM_OTA_BUFSIZE);
+  _otaBuf[1] = (uint8_t*)malloc(WM_OTA_BUFSIZE);
+  _otaQueue  = xQueueCreate(2, sizeof(wm_otablock_t));
+  _otaFree   = xSemaphoreCreateCounting(2, 2);
+  _otaDone   = xSemaphoreCreateBinary();
+  _otaFill   = 0;
+  _otaLen    = 0;
+  _otaError  = false;
+  if (!_otaBuf[0] || !_otaBuf[1] || !_otaQueue || !_otaFree || !_otaDone ||
+      xTaskCreate(otaWriterTask, "wm_ota", 4096, this, WM_OTA_TASK_PRIO, NULL) != pdPASS) {
+    if (_otaDone) {
+      vSemaphoreDelete(_otaDone);
+      _otaDone = NULL; // writer never ran, nothing to wait for
+    }
+    otaPipeFinish(true);
+    return false;
+  }
+  xSemaphoreTake(_otaFree, portMAX_DELAY); // fill buffer 0 first
+  return true;
+}
+
+void WiFiManager::otaPipeWrite(const uint8_t *data, size_t len){
+  while (len) {
+    size_t n = std::min(len, (size_t)(WM_OTA_BUFSIZE - _otaLen));
+    memcpy(_otaBuf[_otaFill] + _otaLen, data, n);
+    _otaLen += n;
+    data    += n;
+    len     -= n;
+    if (_otaLen == WM_OTA_BUFSIZE) otaPipeQueue(false);
+  }
+}
+
+// hands the fill buffer to the writer, waits for the other one unless it was the last
+void WiFiManager::otaPipeQueue(bool last){
+  wm_otablock_t block = {(int8_t)_otaFill, _otaLen};
+  xQueueSend(_otaQueue, &block, portMAX_DELAY);
+  if (last) return;
+  xSemaphoreTake(_otaFree, portMAX_DELAY); // blocks while the writer is behind by a sector
+  _otaFill ^= 1;
+  _otaLen   = 0;
+}
+
+// flushes (or drops on abort) the rest, stops the writer and frees everything, false on write error
+bool WiFiManager::otaPipeFinish(bool abort){
+  if (_otaQueue && _otaDone) {
+    if (!abort && _otaLen) otaPipeQueue(true);
+    wm_otablock_t block = {-1, 0};
+    xQueueSend(_otaQueue, &block, portMAX_DELAY);
+    xSemaphoreTake(_otaDone, portMAX_DELAY);
+  }
+  bool ok = !_otaError && !abort;
+  if (_otaQueue) vQueueDelete(_otaQueue);
+  if (_otaFree)  vSemaphoreDelete(_otaFree);
+  if (_otaDone)  vSemaphoreDelete(_otaDone);
+  free(_otaBuf[0]);
+  free(_otaBuf[1]);
+  _otaBuf[0] = _otaBuf[1] = NULL;
+  _otaQueue = NULL;
+  _otaFree  = NULL;
+  _otaDone  = NULL;
+  return ok;
+}
+
+void WiFiManager::otaWriterTask(void *arg){
+  WiFiManager *wm = (WiFiManager*)arg;
+  wm_otablock_t block;
+  while (xQueueReceive(wm->_otaQueue, &block, portMAX_DELAY) == pdTRUE && block.buf >= 0) {
+    if (!wm->_otaError) {
+      if (wm->otaWrite(wm->_otaBuf[block.buf], block.len)) wm->otaProgress(block.len);
+      else wm->_otaError = true; // keep draining so the handler never blocks
+    }
+    xSemaphoreGive(wm->_otaFree);
+  }
+  xSemaphoreGive(wm->_otaDone);
+  vTaskDelete(NULL);
+}
+#endif
+
+#ifdef WM_OTA_DELTA
+/**
+ * delta ota, see wm_delta.h. The decoder reads the running firmware a window at a time and
+ * writes the rebuilt image through Update, so it needs no more ram than a plain upload and
+ * Update still verifies the image and the optional md5 in end().
+ */
+bool WiFiManager::otaDeltaStart(const uint8_t *data, size_t len){
+  if (!WMDelta::isPatch(data, len)) return true; // plain image
+  _otaBase  = esp_ota_get_running_partition();
+  _otaDelta = new (std::nothrow) WMDelta();
+  if (!_otaBase || !_otaDelta) {
+    #ifdef WM_DEBUG_LEVEL
+    DEBUG_WM(WM_DEBUG_ERROR,F("[ERROR] OTA delta patch alloc failed"));
+    #endif
+    otaDeltaEnd(true);
+    return false;
+  }
+  _otaDelta->begin(otaDeltaRead, otaDeltaWrite, this);
+  #ifdef WM_DEBUG_LEVEL
+  DEBUG_WM(WM_DEBUG_VERBOSE,F("[OTA] delta patch against"), _otaBase->label);
+  #endif
+  return true;
+}
+
+// after the last chunk was flashed, checks a patch was complete. On abort the patch is not
+// finished, only an error the decoder already hit is kept, it is often why the upload failed
+wm_delta_err_t WiFiManager::otaDeltaEnd(bool abort){
+  if (_otaDelta) {
+    _otaDeltaErr = abort ? _otaDelta->error() : _otaDelta->end();
+    delete _otaDelta;
+    _otaDelta = NULL;
+  }
+  return _otaDeltaErr;
+}
+
+bool WiFiManager::otaDeltaRead(void *ctx, uint32_t off, uint8_t *buf, size_t len){
+  WiFiManager *wm = (WiFiManager*)ctx;
+  return esp_partition_read(wm->_otaBase, off, buf, len) == ESP_OK;
+}
+
+bool WiFiManager::otaDeltaWrite(void *ctx, const uint8_t *buf, size_t len){
+  return Update.write((uint8_t*)buf, len) == len;
+}
+#endif
+
 // upload and ota done, show status
 void WiFiManager::handleUpdateDone() {
 	DEBUG_WM(WM_DEBUG_VERBOSE, F("<- Handle update done"));
@@ -3986,14 +4830,20 @@ void WiFiManager::handleUpdateDone() {
 		page += FPSTR(HTTP_UPDATE_FAIL);
     #ifdef ESP32
     page += "OTA Error: " + (String)Update.errorString();
+    #ifdef WM_OTA_DELTA
+    if (_otaDeltaErr != WM_DELTA_OK) page += (String)", " + WMDelta::errorString(_otaDeltaErr);
+    #endif
     #else
     page += "OTA Error: " + (String)Update.getError();
     #endif
-		DEBUG_WM(F("[OTA] update failed"));
+		DEBUG_WM(WM_DEBUG_NOTIFY,F("[OTA] update failed"));
 	}
 	else {
 		page += FPSTR(HTTP_UPDATE_SUCCESS);
-		DEBUG_WM(F("[OTA] update ok"));
+    #ifdef ESP32
+    page += "MD5: " + Update.md5String();
+    #endif
+		DEBUG_WM(WM_DEBUG_NOTIFY,F("[OTA] update ok"));
 	}
 	page += FPSTR(HTTP_END);
 
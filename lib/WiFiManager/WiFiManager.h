@@ -21,6 +21,7 @@
 #endif
 
 #include <vector>
+#include <algorithm>
 
 // #define WM_MDNS            // includes MDNS, also set MDNS with sethostname
 // #define WM_FIXERASECONFIG  // use erase flash fix
@@ -85,6 +86,8 @@
     #include <WiFi.h>
     #include <esp_wifi.h>  
     #include <Update.h>
+    #include <freertos/queue.h>
+    #include <freertos/semphr.h>
     
     #define WIFI_getChipId() (uint32_t)ESP.getEfuseMac()
     #define WM_WIFIOPEN   WIFI_AUTH_OPEN
@@ -129,7 +132,16 @@
 #else
 #endif
 
-#include <DNSServer.h>
+// captive dns answers A queries from a prebuilt record and NODATA for AAAA and others instead of
+// DNSServer's per query parsing, define WM_NODNSRESPONDER to use DNSServer
+#if defined(ESP32) && !defined(WM_NODNSRESPONDER)
+    #define WM_DNS_RESPONDER
+    #include "wm_dns.h"
+    typedef WMDNSResponder WM_DNSServer;
+#else
+    #include <DNSServer.h>
+    typedef DNSServer WM_DNSServer;
+#endif
 #include <memory>
 
 
@@ -140,6 +152,14 @@
 #endif
 #include WM_STRINGS_FILE
 
+// pre-compressed portal style and script, generated by the extras/wm_assets.py pre build step
+// define WM_NOASSETS to keep them inlined in every page
+#if !defined(WM_NOASSETS) && defined(__has_include)
+  #if __has_include("wm_assets.h")
+    #include "wm_assets.h"
+  #endif
+#endif
+
 // prep string concat vars
 #define WM_STRING2(x) #x
 #define WM_STRING(x) WM_STRING2(x)    
@@ -187,9 +207,89 @@
 // #pragma message "VER_ARDUINO_STR = " WM_STRING(VER_ARDUINO_STR)
 
 #ifndef WIFI_MANAGER_MAX_PARAMS
-    #define WIFI_MANAGER_MAX_PARAMS 5 // params will autoincrement and realloc by this amount when max is reached
+    #define WIFI_MANAGER_MAX_PARAMS 5 // deprecated, params no longer realloc, see WM_PARAMS_CAPACITY
+#endif
+
+#ifndef WM_PARAMS_CAPACITY
+    #define WM_PARAMS_CAPACITY 32 // fixed param registry size, addParameter fails when full
+#endif
+// id hash index slots, at least twice the capacity and rounded up to a power of 2, the probe masks with it
+constexpr size_t wmPow2(size_t n){ return n <= 1 ? 1 : 2 * wmPow2((n + 1) / 2); }
+#define WM_PARAMS_INDEX_SIZE wmPow2(WM_PARAMS_CAPACITY * 2)
+static_assert((WM_PARAMS_INDEX_SIZE & (WM_PARAMS_INDEX_SIZE - 1)) == 0, "WM_PARAMS_INDEX_SIZE must be a power of 2");
+static_assert(WM_PARAMS_INDEX_SIZE > WM_PARAMS_CAPACITY, "the id index needs a free slot to end a probe");
+
+// ota upload is copied into sector buffers and flashed by a writer task while the next chunk arrives
+// define WM_NOOTAPIPELINE to write from the upload handler instead
+#if defined(ESP32) && !defined(WM_NOOTAPIPELINE)
+    #define WM_OTA_PIPELINE
+    #ifndef WM_OTA_BUFSIZE
+        #define WM_OTA_BUFSIZE 4096 // one flash sector, two are allocated during the upload
+    #endif
+    #ifndef WM_OTA_TASK_PRIO
+        #define WM_OTA_TASK_PRIO 1 // below the task serving the upload, erases only stall the writer
+    #endif
 #endif
 
+// delta ota, an upload starting with the patch magic is applied against the running firmware
+// patches are made with extras/wm_mkpatch.py, define WM_NODELTAOTA to flash every upload as is
+#if defined(ESP32) && !defined(WM_NODELTAOTA)
+    #define WM_OTA_DELTA
+    #include <esp_ota_ops.h>
+    #include "wm_delta.h"
+#endif
+
+// portal loops sleep in select() on the http and dns sockets instead of spinning on yield(),
+// optionally in a task of their own, see startPortalTask(). define WM_NOPORTALTASK to poll
+#if defined(ESP32) && !defined(WM_NOPORTALTASK)
+    #define WM_PORTAL_TASK
+    #include <lwip/sockets.h>
+    #ifndef WM_PORTAL_TASK_PRIO
+        #define WM_PORTAL_TASK_PRIO 2 // above the ota writer
+    #endif
+    #ifndef WM_PORTAL_TASK_STACK
+        #define WM_PORTAL_TASK_STACK 8192 // page handlers build Strings, scans and connects run here
+    #endif
+    #define WM_PORTAL_IDLE_MS 1000 // longest sleep, portal timeout and flags are checked this often
+    #define WM_PORTAL_POLL_MS 20   // while a client is open, the server times it out by millis()
+#endif
+
+#ifndef WM_INFO_BUFSIZE
+    #define WM_INFO_BUFSIZE 512 // info page is streamed in chunks of this, instead of built as one String
+#endif
+
+// connects end on wifi events, got ip or a disconnect reason that won't recover, instead of status polling
+#ifdef ESP32
+    #define WM_CONNECT_EVENTS
+    #include <freertos/event_groups.h>
+    #include <esp_timer.h>
+    #include <atomic>
+    #define WM_CONNECT_DEFAULT_MS 60000 // no connect timeout set, same as WiFi.waitForConnectResult()
+#endif
+
+// the last WM_CREDS_MAX networks that connected are kept with their connect history, autoConnect
+// tries the quickest one in range before opening the portal, define WM_NOCREDSTORE for the single saved network
+#if defined(ESP32) && !defined(WM_NOCREDSTORE)
+    #define WM_CRED_STORE
+    #include "wm_creds.h"
+    #ifndef WM_CREDS_TRY_MS
+        #define WM_CREDS_TRY_MS 10000 // per stored network when no connect timeout is set
+    #endif
+#endif
+
+// wifi scan snapshot, captured once per completed scan so pages never re-query the driver
+typedef struct {
+    char          ssid[33]; // ssid up to 32 chars + null term
+    int32_t       rssi;
+    uint8_t       enc;
+    int32_t       channel;
+    uint8_t       bssid[6];
+    uint32_t      hash;     // ssid hash for dedupe
+    bool          dup;      // ssid already seen on a stronger ap
+} wm_scanitem_t;
+
+#include "wm_escape.h"
+
 #define WFM_LABEL_BEFORE 1
 #define WFM_LABEL_AFTER 2
 #define WFM_NO_LABEL 0
@@ -245,8 +345,44 @@ class WiFiManagerParameter {
         WM_DEBUG_MAX       = 5  // MAX extra dev auditing, var dumps etc (MAX+1 will print timing,mem and frag info)
     } wm_debuglevel_t;
 
+    // compile time debug ceiling, DEBUG_WM calls above it generate no code and build no args
+    // numeric for #if, 0 silent .. 5 WM_DEBUG_MAX, 6 also prints mem info per line
+    #ifndef WM_DEBUG_COMPILE_LEVEL
+    #define WM_DEBUG_COMPILE_LEVEL 6
+    #endif
+
+    // level is checked before any argument ( String concats etc ) is evaluated
+    #define DEBUG_WM(level, ...) do { if((level) <= WM_DEBUG_COMPILE_LEVEL && _debug && _debugLevel >= (level)) debugWM(level, __VA_ARGS__); } while(0)
+
+    // binary debug ring, format id plus 2 int args, only formatted when dumped, define WM_DEBUG_RINGSIZE entries to enable
+    typedef enum {
+        WM_LOG_SCAN        = 0, // a = aps, b = ms
+        WM_LOG_CONNECT     = 1, // a = wl status, b = ms
+        WM_LOG_DISCONNECT  = 2, // a = reason
+        WM_LOG_PORTAL      = 3, // a = timeout s
+        WM_LOG_TIMEOUT     = 4, // a = ms
+        WM_LOG_CLIENTS     = 5, // a = clients
+        WM_LOG_PARAMSAVE   = 6, // a = params
+        WM_LOG_OTA         = 7  // a = bytes, b = error
+    } wm_logfmt_t;
+
+    #ifdef WM_DEBUG_RINGSIZE
+    typedef struct {
+        uint32_t    ms;
+        uint8_t     level;
+        uint8_t     fmt;  // wm_logfmt_t
+        int32_t     a;
+        int32_t     b;
+    } wm_logrec_t;
+    #define LOG_WM(level, ...) do { if((level) <= WM_DEBUG_COMPILE_LEVEL) logWM(level, __VA_ARGS__); } while(0)
+    #else
+    #define LOG_WM(level, ...) do {} while(0)
+    #endif
+
 class WiFiManager
 {
+  friend struct WMPortalLock;
+
   public:
     WiFiManager(Print& consolePort);
     WiFiManager();
@@ -273,6 +409,13 @@ class WiFiManager
     // Run webserver processing, if setConfigPortalBlocking(false)
     boolean       process();
 
+    #ifdef WM_PORTAL_TASK
+    // serve non blocking config portal and web portal from a task woken by socket activity
+    // process() then does nothing outside of it, use the callbacks for state changes
+    bool          startPortalTask(UBaseType_t priority = WM_PORTAL_TASK_PRIO);
+    TaskHandle_t  getPortalTask();
+    #endif
+
     // get the AP name of the config portal, so it can be used in the callback
     String        getConfigPortalSSID();
     int           getRSSIasQuality(int RSSI);
@@ -299,6 +442,9 @@ class WiFiManager
     // returns the Parameters Count
     int           getParametersCount();
 
+    // returns the first Parameter with id, or NULL
+    WiFiManagerParameter* getParameter(const char *id);
+
     // SET CALLBACKS
 
     //called after AP mode and config portal has started
@@ -325,6 +471,12 @@ class WiFiManager
     //called just before doing OTA update
     void          setPreOtaUpdateCallback( std::function<void()> func );
 
+    //called as OTA data is flashed, total is the request size so done stops a bit short of it
+    void          setOtaProgressCallback( std::function<void(uint32_t done, uint32_t total)> func );
+
+    //called when an OTA upload failed or was aborted, a good one restarts instead
+    void          setOtaFailCallback( std::function<void()> func );
+
     //called when config portal is timeout
     void          setConfigPortalTimeoutCallback( std::function<void()> func );
 
@@ -351,6 +503,11 @@ class WiFiManager
     void          setDebugOutput(boolean debug, String prefix); // log line prefix, default "*wm:"
     void          setDebugOutput(boolean debug, wm_debuglevel_t level ); // log line prefix, default "*wm:"
 
+    #ifdef WM_DEBUG_RINGSIZE
+    // print the binary debug ring, oldest first
+    void          dumpDebugLog(Print &out);
+    #endif
+
     //set min quality percentage to include in scan, defaults to 8% if not specified
     void          setMinimumSignalQuality(int quality = 8);
     
@@ -445,7 +602,37 @@ class WiFiManager
 
     // get last connection result, includes autoconnect and wifisave
     uint8_t       getLastConxResult();
+
+    #ifdef WM_CONNECT_EVENTS
+    // connect without blocking, saved credentials if ssid is empty, one connect at a time
+    // done runs once, on the wifi event or esp_timer task, with WL_CONNECTED as soon as dhcp is done,
+    // or the failure status and disconnect reason (WIFI_REASON_*) as soon as the driver gives up
+    // timeout 0 uses setConnectTimeout, or 60s, persist false tries ssid without saving it, it is saved once connected
+    bool          connectAsync(std::function<void(uint8_t status, uint8_t reason)> done, uint32_t timeout = 0, String ssid = "", String pass = "", bool persist = true);
+
+    // scan without blocking, done runs on the wifi event task once the scan snapshot is updated
+    bool          scanAsync(std::function<void()> done);
+
+    // a connectAsync is in flight, its done has not run yet
+    bool          connectPending();
+
+    // reason of the last station disconnect, WIFI_REASON_*
+    uint8_t       getLastDisconnectReason();
+    #endif
     
+    #ifdef WM_CRED_STORE
+    // connects to the stored networks in range, quickest expected connect first, blocks
+    // skip is left out, e.g. the saved network that just failed, returns the status of the last attempt
+    uint8_t       connectStored(const String &skip = "");
+
+    // the stored networks in range on the last scan snapshot, quickest expected connect first, skip left out
+    // copies up to WM_CREDS_MAX of them to tries and returns the count, doesn't scan or connect
+    uint8_t       rankStored(wm_cred_t *tries, const String &skip = "");
+
+    // stored networks with their connect history
+    const WMCredStore& getCredStore();
+    #endif
+
     // get a status as string
     String        getWLStatusString(uint8_t status);    
     String        getWLStatusString();    
@@ -469,7 +656,11 @@ class WiFiManager
     void          debugPlatformInfo();
 
     // helper for html
-    String        htmlEntities(String str, bool whitespace = false);
+    String        htmlEntities(const String &str, bool whitespace = false);
+
+    // single pass html escaper into a caller buffer, size with htmlEscapeLen()+1
+    static size_t htmlEscapeLen(const char *str, wm_escape_t ctx);
+    static size_t htmlEscape(char *buf, size_t size, const char *str, wm_escape_t ctx);
     
     // set the country code for wifi settings, CN
     void          setCountry(String cc);
@@ -499,13 +690,20 @@ class WiFiManager
     String        getWiFiHostname();
 
 
-    std::unique_ptr<DNSServer>        dnsServer;
+    std::unique_ptr<WM_DNSServer>     dnsServer;
 
     #if defined(ESP32) && defined(WM_WEBSERVERSHIM)
-        using WM_WebServer = WebServer;
+        using WM_WebServerBase = WebServer;
     #else
-        using WM_WebServer = ESP8266WebServer;
+        using WM_WebServerBase = ESP8266WebServer;
     #endif
+
+    // reads the parsed host header in place, hostHeader() returns a copy
+    class WM_WebServer : public WM_WebServerBase {
+      public:
+        using WM_WebServerBase::WM_WebServerBase;
+        const String& hostHeaderRef() const { return _hostHeader; }
+    };
     
     std::unique_ptr<WM_WebServer> server;
 
@@ -532,6 +730,7 @@ class WiFiManager
     unsigned long _lastscan               = 0; // ms for timing wifi scans
     unsigned long _startscan              = 0; // ms for timing wifi scans
     unsigned long _startconn              = 0; // ms for timing wifi connects
+    std::vector<wm_scanitem_t> _scanItems;     // rssi sorted scan snapshot, valid as long as _lastscan
 
     // defaults
     const byte    DNS_PORT                = 53;
@@ -583,6 +782,11 @@ class WiFiManager
     boolean       _shouldBreakAfterConfig = false; // stop configportal on save failure
     boolean       _configPortalIsBlocking = true;  // configportal enters blocking loop 
     boolean       _enableCaptivePortal    = true;  // enable captive portal redirection
+    uint32_t      _serverLocIp            = 0;     // ip the cached location and redirect were built for
+    uint8_t       _serverLocLen           = 0;
+    uint8_t       _redirectLen            = 0;
+    char          _serverLoc[22]          = "";    // "255.255.255.255:65535", what the host header must be
+    char          _redirect[160]          = "";    // complete 302 to it
     boolean       _userpersistent         = true;  // users preffered persistence to restore
     boolean       _wifiAutoReconnect      = true;  // there is no platform getter for this, we must assume its true and make it so
     boolean       _apClientCheck          = false; // keep cp alive if ap have station
@@ -656,10 +860,34 @@ class WiFiManager
     uint8_t       connectWifi(String ssid, String pass, bool connect = true);
     bool          setSTAConfig();
     bool          wifiConnectDefault();
-    bool          wifiConnectNew(String ssid, String pass,bool connect = true);
+    bool          wifiConnectNew(String ssid, String pass,bool connect = true,bool persist = true);
 
     uint8_t       waitForConnectResult();
     uint8_t       waitForConnectResult(uint32_t timeout);
+    #ifdef WM_CONNECT_EVENTS
+    void          connectBegin();
+    void          connectFinish(uint8_t status);
+    static void   connectTimeout(void *arg);
+
+    EventGroupHandle_t _connectEvents = NULL;  // WM_CONN_* bits, set by WiFiEvent
+    esp_timer_handle_t _connectTimer  = NULL;  // connectAsync timeout
+    std::function<void(uint8_t,uint8_t)> _connectDone;
+    std::atomic<bool>  _connectPending{false};
+    bool               _connectPersist = true;  // else the STA config is saved once the connect succeeds
+    std::function<void()> _scanDone;           // scanAsync, cleared when it runs
+    #ifdef WM_CRED_STORE
+    String             _connectSSID;           // tried by the pending connect, for the connect history
+    String             _connectPass;
+    unsigned long      _connectStart = 0;
+    #endif
+    volatile uint8_t   _disconnectReason = 0;
+    #endif
+
+    #ifdef WM_CRED_STORE
+    WMCredStore       _creds;                 // loaded on first use, nvs is up by then
+    bool              _credsLoaded = false;
+    WMCredStore&      creds();
+    #endif
     void          updateConxResult(uint8_t status);
 
     // webserver handlers
@@ -679,18 +907,75 @@ private:
     void          handleErase(boolean opt);
     void          handleParam();
     void          handleWiFiStatus();
+    #ifdef WM_DEBUG_RINGSIZE
+    void          handleLog();
+    #endif
     void          handleRequest();
+    #ifdef WM_ASSETS_GZ
+    void          handleAsset(const uint8_t *gz, size_t len, PGM_P etag, PGM_P type);
+    #endif
     void          handleParamSave();
     void          doParamSave();
 
     boolean       captivePortal();
+    void          setServerLoc(uint32_t ip);
     boolean       configPortalHasTimeout();
     uint8_t       processConfigPortal();
     void          stopCaptivePortal();
+    #ifdef WM_PORTAL_TASK
+    bool          portalRunning();
+    int           portalFds(fd_set &rd, uint32_t &ms);
+    void          waitPortalEvent(uint32_t ms);
+    void          portalSelect(fd_set &rd, int maxfd, uint32_t ms);
+    int           findSocket(int type, uint16_t port);
+    static void   portalTaskLoop(void *arg);
+
+    TaskHandle_t      _portalTask = NULL;
+    SemaphoreHandle_t _portalLock = NULL; // recursive, held around process() by the portal task
+    int               _httpFd     = -1;   // listening sockets, found after the servers start
+    int               _dnsFd      = -1;
+    #endif
+
 	// OTA Update handler
 	void          handleUpdate();
 	void          handleUpdating();
 	void          handleUpdateDone();
+    void          otaProgress(uint32_t done);
+    bool          otaWrite(uint8_t *data, size_t len);
+    #ifdef WM_OTA_DELTA
+    bool          otaDeltaStart(const uint8_t *data, size_t len);
+    wm_delta_err_t otaDeltaEnd(bool abort);
+    static bool   otaDeltaRead(void *ctx, uint32_t off, uint8_t *buf, size_t len);
+    static bool   otaDeltaWrite(void *ctx, const uint8_t *buf, size_t len);
+
+    WMDelta*               _otaDelta    = NULL;  // upload is a patch, decoded into Update
+    const esp_partition_t* _otaBase     = NULL;  // running firmware the patch applies to
+    bool                   _otaFirst    = false; // next chunk is the first, decides patch or image
+    wm_delta_err_t         _otaDeltaErr = WM_DELTA_OK;
+    #endif
+    #ifdef WM_OTA_PIPELINE
+    bool          otaPipeStart();
+    void          otaPipeWrite(const uint8_t *data, size_t len);
+    void          otaPipeQueue(bool last);
+    bool          otaPipeFinish(bool abort);
+    static void   otaWriterTask(void *arg);
+
+    // buffer handed to the writer task, buf -1 ends the task
+    typedef struct {
+      int8_t   buf;
+      uint16_t len;
+    } wm_otablock_t;
+
+    uint8_t*          _otaBuf[2]  = {NULL, NULL};
+    uint8_t           _otaFill    = 0;     // buffer the upload is copied into
+    uint16_t          _otaLen     = 0;     // bytes in the fill buffer
+    QueueHandle_t     _otaQueue   = NULL;  // full buffers to the writer
+    SemaphoreHandle_t _otaFree    = NULL;  // buffers the writer is done with
+    SemaphoreHandle_t _otaDone    = NULL;  // given when the writer exits
+    volatile bool     _otaError   = false; // a flash write failed, rest of the upload is dropped
+    #endif
+    uint32_t          _otaWritten = 0;
+    uint32_t          _otaTotal   = 0;
 
 
     // wifi platform abstractions
@@ -710,6 +995,10 @@ private:
     bool          WiFi_scanNetworks(unsigned int cachetime,bool async);
     bool          WiFi_scanNetworks(unsigned int cachetime);
     void          WiFi_scanComplete(int networksFound);
+    void          WiFi_scanSnapshot(int networksFound);
+    #ifdef ESP32
+    void          WiFi_saveSTAConfig();
+    #endif
     bool          WiFiSetCountry();
 
     #ifdef ESP32
@@ -757,10 +1046,70 @@ private:
     //helpers
     boolean       isIp(String str);
     String        toStringIp(IPAddress ip);
+    uint32_t      hashStr(const char *str);
     boolean       validApPassword();
     String        encryptionTypeStr(uint8_t authmode);
     void          reportStatus(String &page);
-    String        getInfoData(String id);
+    // info page fields in page order, _infoFields in the .cpp follows the same #ifdefs
+    enum wm_info_t : uint8_t {
+      WM_INFO_ESPHEAD,
+      WM_INFO_UPTIME,
+      WM_INFO_CHIPID,
+      #ifdef ESP8266
+      WM_INFO_FCHIPID,
+      #elif defined(ESP32)
+      WM_INFO_CHIPREV,
+      #endif
+      WM_INFO_IDESIZE,
+      WM_INFO_FLASHSIZE,
+      #ifdef ESP8266
+      WM_INFO_COREVER,
+      WM_INFO_BOOTVER,
+      #endif
+      WM_INFO_CPUFREQ,
+      WM_INFO_FREEHEAP,
+      WM_INFO_MEMSKETCH,
+      WM_INFO_MEMSMETER,
+      #if defined(ESP8266) || (defined(ESP32) && defined(_ROM_RTC_H_))
+      WM_INFO_LASTRESET,
+      #endif
+      #if defined(ESP32) && !defined(WM_NOTEMP)
+      WM_INFO_TEMP,
+      #endif
+      WM_INFO_WIFIHEAD,
+      WM_INFO_CONX,
+      WM_INFO_STASSID,
+      WM_INFO_STAIP,
+      WM_INFO_STAGW,
+      WM_INFO_STASUB,
+      WM_INFO_DNSS,
+      WM_INFO_HOST,
+      WM_INFO_STAMAC,
+      #ifdef ESP8266
+      WM_INFO_AUTOCONX,
+      #ifndef WM_NOSOFTAPSSID
+      WM_INFO_APSSID,
+      #endif
+      #endif
+      WM_INFO_APIP,
+      WM_INFO_APMAC,
+      #ifdef ESP32
+      WM_INFO_APHOST,
+      #endif
+      WM_INFO_APBSSID,
+      WM_INFO_ABOUTVER, // about section
+      WM_INFO_ABOUTARDUINO,
+      WM_INFO_ABOUTDATE,
+      WM_INFO_MAX
+    };
+    struct wm_infofield_t {
+      PGM_P       tpl;      // row with {1} and {2} tokens
+      bool        cached;   // can't change while running, rendered on the first visit only
+      void      (*values)(WiFiManager &wm, String &v1, String &v2);
+    };
+    static const wm_infofield_t _infoFields[];
+    std::unique_ptr<String[]>   _infoCache;  // cached rows by wm_info_t, allocated on the first info page
+
 
     // flags
     boolean       connect             = false;
@@ -782,8 +1131,10 @@ private:
     
     // WiFiManagerParameter
     int         _paramsCount          = 0;
-    int         _max_params;
-    WiFiManagerParameter** _params    = NULL;
+    WiFiManagerParameter* _params[WM_PARAMS_CAPACITY]; // fixed registry, no realloc
+    int16_t     _paramIndex[WM_PARAMS_INDEX_SIZE]; // open addressed id hash index into _params, -1 empty
+    int16_t     _paramNext[WM_PARAMS_CAPACITY];    // next param sharing the same id, -1 end
+    int         findParameter(const char *id);
 
     boolean _debug  = true;
     String _debugPrefix = FPSTR(S_debugPrefix);
@@ -817,14 +1168,19 @@ private:
     #endif
 
     template <typename Generic>
-    void        DEBUG_WM(Generic text);
-
-    template <typename Generic>
-    void        DEBUG_WM(wm_debuglevel_t level,Generic text);
-    template <typename Generic, typename Genericb>
-    void        DEBUG_WM(Generic text,Genericb textb);
+    void        debugWM(wm_debuglevel_t level,Generic text);
     template <typename Generic, typename Genericb>
-    void        DEBUG_WM(wm_debuglevel_t level, Generic text,Genericb textb);
+    void        debugWM(wm_debuglevel_t level, Generic text,Genericb textb);
+
+    #ifdef WM_DEBUG_RINGSIZE
+    wm_logrec_t _logRing[WM_DEBUG_RINGSIZE]; // binary debug ring
+    uint16_t    _logHead              = 0;   // next write
+    uint32_t    _logCount             = 0;   // total records written
+    #ifdef ESP32
+    portMUX_TYPE _logMux              = portMUX_INITIALIZER_UNLOCKED; // wifi events log from the event task
+    #endif
+    void        logWM(wm_debuglevel_t level, wm_logfmt_t fmt, int32_t a = 0, int32_t b = 0);
+    #endif
 
     // callbacks
     // @todo use cb list (vector) maybe event ids, allow no return value
@@ -836,6 +1192,8 @@ private:
     std::function<void()> _saveparamscallback;
     std::function<void()> _resetcallback;
     std::function<void()> _preotaupdatecallback;
+    std::function<void(uint32_t,uint32_t)> _otaprogresscallback;
+    std::function<void()> _otafailcallback;
     std::function<void()> _configportaltimeoutcallback;
 
     template <class T>
@@ -0,0 +1,119 @@
+"""
+wm_assets.py
+pre build step for WiFiManager, gzips the portal style and script into PROGMEM blobs
+
+Extracts HTTP_STYLE and HTTP_SCRIPT from the strings file, strips the wrapping tags,
+gzips them and writes wm_assets.h next to WiFiManager.h. When the header exists the
+portal serves them as separate cacheable routes (/wm.css, /wm.js) with an ETag instead
+of inlining them into every page.
+
+platformio.ini
+  extra_scripts = pre:lib/WiFiManager/extras/wm_assets.py
+
+standalone
+  python wm_assets.py [strings file]
+"""
+
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+LIBDIR = None
+STRINGS = "wm_strings_en.h"
+OUTPUT = "wm_assets.h"
+
+ASSETS = (
+    # name, source const, tag to strip, route
+    ("CSS", "HTTP_STYLE", "style", "/wm.css"),
+    ("JS", "HTTP_SCRIPT", "script", "/wm.js"),
+)
+
+
+def c_unescape(s):
+    return bytes(s, "utf-8").decode("unicode_escape").encode("latin-1").decode("utf-8")
+
+
+def read_const(src, name):
+    """ concatenate the string literals of `const char name[] PROGMEM = "..." "...";` """
+    m = re.search(r"const\s+char\s+" + name + r"\[\]\s+PROGMEM\s*=(.*?);\s*(//.*)?$", src, re.S | re.M)
+    if not m:
+        raise ValueError("%s not found" % name)
+    body = re.sub(r"//[^\n]*", "", re.sub(r'"(?:\\.|[^"\\])*"', lambda l: l.group(0).replace("//", "\\x2f\\x2f"), m.group(1)))
+    return "".join(c_unescape(l) for l in re.findall(r'"((?:\\.|[^"\\])*)"', body))
+
+
+def strip_tag(s, tag):
+    return re.sub(r"^\s*<%s[^>]*>|</%s>\s*$" % (tag, tag), "", s)
+
+
+def carray(data):
+    rows = []
+    for i in range(0, len(data), 16):
+        rows.append("  " + ",".join("0x%02x" % b for b in data[i:i + 16]))
+    return ",\n".join(rows)
+
+
+def generate(libdir, strings=STRINGS):
+    with open(os.path.join(libdir, strings), encoding="utf-8") as f:
+        src = f.read()
+
+    out = [
+        "// generated by extras/wm_assets.py from %s, do not edit" % strings,
+        "#ifndef _WM_ASSETS_H_",
+        "#define _WM_ASSETS_H_",
+        "",
+        "#define WM_ASSETS_GZ 1",
+        "",
+    ]
+    head = ""
+    for name, const, tag, route in ASSETS:
+        raw = strip_tag(read_const(src, const), tag).encode("utf-8")
+        gz = gzip.compress(raw, 9, mtime=0)
+        etag = hashlib.sha1(raw).hexdigest()[:16]
+        out += [
+            "// %s %d bytes, gzip %d bytes" % (route, len(raw), len(gz)),
+            'const char    WM_ASSET_%s_ETAG[] PROGMEM = "\\"%s\\"";' % (name, etag),
+            "const size_t  WM_ASSET_%s_LEN = %d;" % (name, len(gz)),
+            "const uint8_t WM_ASSET_%s_GZ[] PROGMEM = {\n%s\n};" % (name, carray(gz)),
+            "",
+        ]
+        # versioned urls, so max-age can never serve stale assets after an update
+        if tag == "style":
+            head += "<link rel='stylesheet' href='%s?v=%s'>" % (route, etag)
+        else:
+            head += "<script src='%s?v=%s'></script>" % (route, etag)
+
+    out += [
+        'const char    WM_ASSET_HEAD[] PROGMEM = "%s";' % head,
+        "",
+        "#endif",
+        "",
+    ]
+    text = "\n".join(out)
+
+    path = os.path.join(libdir, OUTPUT)
+    if os.path.exists(path):
+        with open(path, encoding="utf-8") as f:
+            if f.read() == text:
+                return path # unchanged, keep mtime so nothing rebuilds
+    with open(path, "w", encoding="utf-8") as f:
+        f.write(text)
+    print("wm_assets: generated %s" % path)
+    return path
+
+
+def strings_from_env(env):
+    for d in env.get("CPPDEFINES", []):
+        if isinstance(d, (list, tuple)) and d[0] == "WM_STRINGS_FILE":
+            return os.path.basename(str(d[1]).strip('\\"'))
+    return STRINGS
+
+
+try:
+    Import("env")  # noqa: F821, platformio pre script
+    generate(os.path.join(env.subst("$PROJECT_DIR"), "lib", "WiFiManager"), strings_from_env(env))  # noqa: F821
+except NameError:
+    if __name__ == "__main__":
+        generate(os.path.dirname(os.path.dirname(os.path.abspath(__file__))), *sys.argv[1:2])
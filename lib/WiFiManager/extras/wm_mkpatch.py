@@ -0,0 +1,206 @@
+"""
+wm_mkpatch.py
+makes a delta ota patch for WiFiManager, see wm_delta.h for the format
+
+The patch rebuilds new.bin from the firmware running on the device, old.bin must be the exact
+image that was flashed (.pio/build/<env>/firmware.bin of that build). Upload the patch on the
+portal update page like a normal firmware, it is recognized by its magic.
+
+Matching is bsdiff like: 8 byte seeds from an index of the old image, extended forward while
+at least half of the bytes agree, so code that moved and had its pointers changed is one
+aligned region of COPY runs with short DIFF runs in between. Everything unmatched is LIT.
+Every patch is applied again here and compared before it is written.
+
+usage
+  python wm_mkpatch.py old.bin new.bin out.patch
+  python wm_mkpatch.py --apply old.bin in.patch out.bin
+"""
+
+import struct
+import sys
+import zlib
+
+MAGIC = b"WMDP"
+VERSION = 1
+HDR = struct.Struct("<4sB3xIIII")  # magic, version, old size, old crc, new size, new crc
+
+COPY, DIFF, LIT, SEEK = range(4)
+
+SEED = 8        # seed length, shorter matches are not worth an op
+STRIDE = 4      # old image positions indexed, finds every match of SEED + STRIDE - 1
+MIN_COPY = 3    # shorter equal runs inside a match are cheaper as DIFF
+
+
+def varint(v):
+    out = bytearray()
+    while v >= 0x80:
+        out.append((v & 0x7F) | 0x80)
+        v >>= 7
+    out.append(v)
+    return bytes(out)
+
+
+class Writer:
+    def __init__(self):
+        self.out = bytearray()
+        self.src = 0
+
+    def op(self, code, n, data=b""):
+        self.out += varint(n << 2 | code)
+        self.out += data
+
+    def seek(self, to):
+        d = to - self.src
+        if d:
+            self.op(SEEK, (d << 1) ^ (d >> 63))  # zigzag
+            self.src = to
+
+    def lit(self, data):
+        if data:
+            self.op(LIT, len(data), data)
+
+    def region(self, old, new, o, n, length):
+        """ new[n:n+length] against old[o:o+length] as COPY and DIFF runs """
+        self.seek(o)
+        eq = [old[o + x] == new[n + x] for x in range(length)]
+        i = 0
+        while i < length:
+            j = i
+            while j < length and eq[j]:
+                j += 1
+            if j - i >= MIN_COPY or (j == length and j > i):
+                self.op(COPY, j - i)
+                i = j
+                continue
+            # diff up to the next equal run worth a COPY, shorter ones are taken along
+            k = i
+            while k < length:
+                if eq[k]:
+                    e = k
+                    while e < length and eq[e]:
+                        e += 1
+                    if e - k >= MIN_COPY or e == length:
+                        break
+                    k = e
+                else:
+                    k += 1
+            self.op(DIFF, k - i, bytes((new[n + x] - old[o + x]) & 0xFF for x in range(i, k)))
+            i = k
+        self.src = o + length
+
+
+def extend(old, new, o, n):
+    """ bsdiff forward extension, longest length where matches still outnumber mismatches """
+    best = length = score = 0
+    limit = min(len(old) - o, len(new) - n)
+    for k in range(limit):
+        if old[o + k] == new[n + k]:
+            score += 1
+        if 2 * score - (k + 1) > 2 * best - length:
+            best = score
+            length = k + 1
+        elif k + 1 - length > 64 and 2 * score - (k + 1) < 2 * best - length - 64:
+            break  # fell well behind the best, no recovery this far out
+    return length
+
+
+def make(old, new):
+    index = {}
+    for p in range(0, len(old) - SEED + 1, STRIDE):
+        index.setdefault(old[p:p + SEED], p)
+
+    w = Writer()
+    lit = 0   # start of the pending literal
+    i = 0
+    while i + SEED <= len(new):
+        key = new[i:i + SEED]
+        # stay on the current alignment if it still matches, relocations keep it
+        diag = w.src + (i - lit)
+        if old[diag:diag + SEED] == key:
+            o = diag
+        else:
+            o = index.get(key)
+            if o is None:
+                i += 1
+                continue
+        # exact backward extension into the pending literal
+        b = 0
+        while i - b > lit and o - b > 0 and old[o - b - 1] == new[i - b - 1]:
+            b += 1
+        o -= b
+        i -= b
+        length = extend(old, new, o, i)
+        w.lit(new[lit:i])
+        w.region(old, new, o, i, length)
+        i += length
+        lit = i
+    w.lit(new[lit:])
+
+    hdr = HDR.pack(MAGIC, VERSION, len(old), zlib.crc32(old), len(new), zlib.crc32(new))
+    return hdr + bytes(w.out)
+
+
+def apply(old, patch):
+    magic, version, old_size, old_crc, new_size, new_crc = HDR.unpack_from(patch)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("not a version %d patch" % VERSION)
+    if old_size != len(old) or old_crc != zlib.crc32(old):
+        raise ValueError("patch is for another image")
+    out = bytearray()
+    src = 0
+    p = HDR.size
+    while len(out) < new_size:
+        v = shift = 0
+        while True:
+            c = patch[p]
+            p += 1
+            v |= (c & 0x7F) << shift
+            shift += 7
+            if not c & 0x80:
+                break
+        code, n = v & 3, v >> 2
+        if code == SEEK:
+            src += (n >> 1) ^ -(n & 1)
+        elif code == COPY:
+            out += old[src:src + n]
+            src += n
+        elif code == DIFF:
+            out += bytes((old[src + x] + patch[p + x]) & 0xFF for x in range(n))
+            src += n
+            p += n
+        else:
+            out += patch[p:p + n]
+            p += n
+    if p != len(patch) or len(out) != new_size or zlib.crc32(out) != new_crc:
+        raise ValueError("patch does not reproduce the image")
+    return bytes(out)
+
+
+def main(argv):
+    if len(argv) == 4 and argv[0] == "--apply":
+        old, patch, out = argv[1:]
+        with open(old, "rb") as f:
+            old = f.read()
+        with open(patch, "rb") as f:
+            patch = f.read()
+        with open(out, "wb") as f:
+            f.write(apply(old, patch))
+        return 0
+    if len(argv) != 3:
+        print(__doc__.strip())
+        return 1
+    with open(argv[0], "rb") as f:
+        old = f.read()
+    with open(argv[1], "rb") as f:
+        new = f.read()
+    patch = make(old, new)
+    if apply(old, patch) != new:
+        raise SystemExit("wm_mkpatch: round trip failed, not written")
+    with open(argv[2], "wb") as f:
+        f.write(patch)
+    print("wm_mkpatch: %d -> %d bytes (%.1f%% of the image)" % (len(new), len(patch), 100.0 * len(patch) / max(len(new), 1)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -60,6 +60,9 @@ const char R_erase[]              PROGMEM = "/erase";
 const char R_status[]             PROGMEM = "/status";
 const char R_update[]             PROGMEM = "/update";
 const char R_updatedone[]         PROGMEM = "/u";
+const char R_css[]                PROGMEM = "/wm.css";
+const char R_js[]                 PROGMEM = "/wm.js";
+const char R_log[]                PROGMEM = "/log";
 
 
 //Strings
@@ -98,6 +101,27 @@ const char HTTP_HEAD_CT[]         PROGMEM = "text/html";
 const char HTTP_HEAD_CT2[]        PROGMEM = "text/plain";
 const char HTTP_HEAD_CORS[]       PROGMEM = "Access-Control-Allow-Origin";
 const char HTTP_HEAD_CORS_ALLOW_ALL[]  PROGMEM = "*";
+const char HTTP_HEAD_CT_CSS[]     PROGMEM = "text/css";
+const char HTTP_HEAD_CT_JS[]      PROGMEM = "application/javascript";
+const char HTTP_HEAD_ETAG[]       PROGMEM = "ETag";
+const char HTTP_HEAD_INM[]        PROGMEM = "If-None-Match";
+const char HTTP_HEAD_CE[]         PROGMEM = "Content-Encoding";
+const char HTTP_HEAD_CE_GZIP[]    PROGMEM = "gzip";
+const char HTTP_HEAD_CC[]         PROGMEM = "Cache-Control";
+const char HTTP_HEAD_CC_ASSET[]   PROGMEM = "max-age=86400"; // asset urls are versioned by hash
+
+// debug ring formats, index by wm_logfmt_t
+const char * const WM_LOG_FMT[] PROGMEM
+{
+  "scan found %d aps in %d ms",        // WM_LOG_SCAN
+  "connect result %d in %d ms",        // WM_LOG_CONNECT
+  "sta disconnected reason %d",        // WM_LOG_DISCONNECT
+  "portal started, timeout %d s",      // WM_LOG_PORTAL
+  "portal timeout after %d ms",        // WM_LOG_TIMEOUT
+  "portal clients %d",                 // WM_LOG_CLIENTS
+  "saved %d params",                   // WM_LOG_PARAMSAVE
+  "ota %d bytes, error %d"             // WM_LOG_OTA
+};
 
 const char * const WIFI_STA_STATUS[] PROGMEM
 {
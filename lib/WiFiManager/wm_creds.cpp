@@ -0,0 +1,108 @@
+/**
+ * wm_creds.cpp
+ *
+ * credential store, see wm_creds.h
+ *
+ * The list is one nvs blob in most recently connected order, a version byte in front. It is
+ * only written when a connect result changes it, which is once per connect at most.
+ *
+ * @license MIT
+ */
+
+#include "wm_creds.h"
+#include <Preferences.h>
+
+#define WM_CREDS_NS  "wmcreds"
+
+void WMCredStore::begin(){
+  Preferences prefs;
+  _count = 0;
+  if(!prefs.begin(WM_CREDS_NS, true)) return; // nothing stored yet
+  if(prefs.getUChar("ver", 0) == WM_CREDS_VERSION){
+    _count = prefs.getBytes("list", _creds, sizeof(_creds)) / sizeof(wm_cred_t);
+  }
+  prefs.end();
+}
+
+int WMCredStore::find(const char *ssid) const {
+  for(uint8_t i = 0; i < _count; i++){
+    if(strcmp(_creds[i].ssid, ssid) == 0) return i;
+  }
+  return -1;
+}
+
+void WMCredStore::success(const char *ssid, const char *pass, uint32_t ms){
+  if(!ssid || !*ssid) return;
+  int i = find(ssid);
+  if(i < 0){
+    // new network in front, the oldest falls off when full
+    if(_count < WM_CREDS_MAX) _count++;
+    i = _count - 1;
+    memset(&_creds[i], 0, sizeof(wm_cred_t));
+    strncpy(_creds[i].ssid, ssid, sizeof(_creds[i].ssid) - 1);
+  }
+  wm_cred_t &c = _creds[i];
+  strncpy(c.pass, pass ? pass : "", sizeof(c.pass) - 1);
+  c.pass[sizeof(c.pass) - 1] = '\0';
+  ms = ms > 0xFFFF ? 0xFFFF : (ms ? ms : 1);
+  c.connMs = c.connMs ? (c.connMs * 3 + ms) / 4 : ms; // quarter weight on the newest
+  c.fails  = 0;
+  front(i);
+  save();
+}
+
+void WMCredStore::failure(const char *ssid){
+  int i = find(ssid);
+  if(i < 0) return;
+  if(_creds[i].fails < 0xFF) _creds[i].fails++;
+  save();
+}
+
+void WMCredStore::clear(){
+  _count = 0;
+  Preferences prefs;
+  if(!prefs.begin(WM_CREDS_NS, false)) return;
+  prefs.clear();
+  prefs.end();
+}
+
+uint8_t WMCredStore::rank(const int8_t rssi[WM_CREDS_MAX], uint8_t order[WM_CREDS_MAX]) const {
+  uint32_t cost[WM_CREDS_MAX];
+  uint8_t n = 0;
+  for(uint8_t i = 0; i < _count; i++){
+    if(rssi[i] == INT8_MIN) continue; // not in range
+    uint32_t c = expectedMs(i, rssi[i]);
+    // insertion sort, at most WM_CREDS_MAX entries and ties keep recency order
+    uint8_t j = n++;
+    for(; j > 0 && cost[j - 1] > c; j--){
+      cost[j]  = cost[j - 1];
+      order[j] = order[j - 1];
+    }
+    cost[j]  = c;
+    order[j] = i;
+  }
+  return n;
+}
+
+// connect time over the chance it works, taken as 1 / (1 + failures in a row)
+uint32_t WMCredStore::expectedMs(uint8_t i, int8_t rssi) const {
+  const wm_cred_t &c = _creds[i];
+  uint32_t ms = c.connMs ? c.connMs : WM_CREDS_UNKNOWN_MS;
+  if(rssi < WM_CREDS_WEAK_RSSI) ms += (WM_CREDS_WEAK_RSSI - rssi) * WM_CREDS_WEAK_MS;
+  return ms * (1 + c.fails);
+}
+
+void WMCredStore::front(uint8_t i){
+  if(i == 0) return;
+  wm_cred_t c = _creds[i];
+  memmove(&_creds[1], &_creds[0], i * sizeof(wm_cred_t));
+  _creds[0] = c;
+}
+
+void WMCredStore::save(){
+  Preferences prefs;
+  if(!prefs.begin(WM_CREDS_NS, false)) return;
+  prefs.putUChar("ver", WM_CREDS_VERSION);
+  prefs.putBytes("list", _creds, _count * sizeof(wm_cred_t));
+  prefs.end();
+}
@@ -0,0 +1,63 @@
+/**
+ * wm_creds.h
+ *
+ * credential store, the last WM_CREDS_MAX networks that connected, kept in nvs with
+ * their connect history so a reconnect can try the quickest one in range first
+ *
+ * @license MIT
+ */
+
+#ifndef _WM_CREDS_H_
+#define _WM_CREDS_H_
+
+#include <Arduino.h>
+
+#ifndef WM_CREDS_MAX
+    #define WM_CREDS_MAX 5 // networks kept, least recently connected is dropped
+#endif
+#define WM_CREDS_VERSION    1
+#define WM_CREDS_UNKNOWN_MS 5000 // expected connect time of a network that never connected
+#define WM_CREDS_WEAK_RSSI  -70  // below this every dB adds WM_CREDS_WEAK_MS
+#define WM_CREDS_WEAK_MS    100
+
+typedef struct {
+    char          ssid[33];
+    char          pass[65];
+    uint16_t      connMs;   // smoothed connect time, 0 never connected
+    uint8_t       fails;    // failed connects since the last success
+    uint8_t       reserved;
+} wm_cred_t;
+
+class WMCredStore {
+  public:
+    // reads the list from nvs, empty when missing or from another version
+    void              begin();
+    uint8_t           count() const { return _count; }
+    // entry i, 0 is the last network that connected
+    const wm_cred_t&  get(uint8_t i) const { return _creds[i]; }
+    int               find(const char *ssid) const;
+
+    // a connect to ssid succeeded after ms, adds or updates it as the most recent
+    void              success(const char *ssid, const char *pass, uint32_t ms);
+    // a connect to ssid failed, only counted for stored networks
+    void              failure(const char *ssid);
+    void              clear();
+
+    /**
+     * orders the stored networks seen in a scan by expected connect time
+     * @param rssi  per entry, INT8_MIN when not in the scan
+     * @param order receives entry indices, quickest first
+     * @return number of entries in order
+     */
+    uint8_t           rank(const int8_t rssi[WM_CREDS_MAX], uint8_t order[WM_CREDS_MAX]) const;
+    uint32_t          expectedMs(uint8_t i, int8_t rssi) const;
+
+  private:
+    void              front(uint8_t i);
+    void              save();
+
+    wm_cred_t         _creds[WM_CREDS_MAX];
+    uint8_t           _count = 0;
+};
+
+#endif
@@ -0,0 +1,195 @@
+/**
+ * wm_delta.cpp
+ *
+ * streaming decoder for delta ota patches, see wm_delta.h for the format
+ *
+ * @license MIT
+ */
+
+#include "wm_delta.h"
+#include <string.h>
+
+// crc32 (zlib, reflected 0xEDB88320) a nibble at a time, 64 bytes of table
+static const uint32_t crcNibble[16] = {
+  0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+  0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+static uint32_t le32(const uint8_t *p){
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+template <typename T> static T lesser(T a, T b){
+  return a < b ? a : b;
+}
+
+bool WMDelta::isPatch(const uint8_t *data, size_t len){
+  return len >= 4 && memcmp(data, WM_DELTA_MAGIC, 4) == 0;
+}
+
+uint32_t WMDelta::crc32(uint32_t crc, const uint8_t *data, size_t len){
+  crc = ~crc;
+  while (len--) {
+    crc ^= *data++;
+    crc = (crc >> 4) ^ crcNibble[crc & 0x0F];
+    crc = (crc >> 4) ^ crcNibble[crc & 0x0F];
+  }
+  return ~crc;
+}
+
+void WMDelta::begin(wm_delta_read_t read, wm_delta_write_t write, void *ctx){
+  _read    = read;
+  _write   = write;
+  _ctx     = ctx;
+  _state   = S_HEADER;
+  _err     = WM_DELTA_OK;
+  _hdrLen  = 0;
+  _varint  = 0;
+  _shift   = 0;
+  _left    = 0;
+  _src     = 0;
+  _oldSize = 0;
+  _newSize = 0;
+  _newCrc  = 0;
+  _out     = 0;
+  _crc     = 0;
+}
+
+wm_delta_err_t WMDelta::feed(const uint8_t *data, size_t len){
+  while (len && _err == WM_DELTA_OK) {
+    switch (_state) {
+      case S_HEADER: {
+        size_t n = lesser(len, (size_t)(WM_DELTA_HDRSIZE - _hdrLen));
+        memcpy(_hdr + _hdrLen, data, n);
+        _hdrLen += n;
+        data    += n;
+        len     -= n;
+        if (_hdrLen == WM_DELTA_HDRSIZE) header();
+        break;
+      }
+      case S_OP: {
+        uint8_t b = *data++;
+        len--;
+        _varint |= (uint64_t)(b & 0x7F) << _shift;
+        _shift  += 7;
+        if (b & 0x80) {
+          if (_shift > 35) fail(WM_DELTA_ERR_RANGE); // op argument wider than 32 bits
+          break;
+        }
+        uint64_t v = _varint;
+        _varint = 0;
+        _shift  = 0;
+        if (v >> 34) fail(WM_DELTA_ERR_RANGE);
+        else op(v & 3, (uint32_t)(v >> 2));
+        break;
+      }
+      case S_DATA: {
+        size_t n = lesser(len, (size_t)_left);
+        if (_op == WM_DELTA_LIT) {
+          if (!emit(data, n)) fail(WM_DELTA_ERR_WRITE);
+        }
+        else {
+          // DIFF, one window of the old image at a time
+          n = lesser(n, (size_t)WM_DELTA_WINDOW);
+          if (!_read(_ctx, _src, _win, n)) {
+            fail(WM_DELTA_ERR_READ);
+            break;
+          }
+          for (size_t i = 0; i < n; i++) _win[i] += data[i];
+          _src += n;
+          if (!emit(_win, n)) fail(WM_DELTA_ERR_WRITE);
+        }
+        data  += n;
+        len   -= n;
+        _left -= n;
+        if (!_left) _state = _out == _newSize ? S_DONE : S_OP;
+        break;
+      }
+      case S_DONE:
+        fail(WM_DELTA_ERR_TRAILING);
+        break;
+    }
+  }
+  return _err;
+}
+
+wm_delta_err_t WMDelta::end(){
+  if (_err != WM_DELTA_OK) return _err;
+  if (_state != S_DONE) return fail(WM_DELTA_ERR_TRUNCATED);
+  if (_crc != _newCrc) return fail(WM_DELTA_ERR_CRC);
+  return WM_DELTA_OK;
+}
+
+const char* WMDelta::errorString(wm_delta_err_t err){
+  switch (err) {
+    case WM_DELTA_OK:            return "ok";
+    case WM_DELTA_ERR_MAGIC:     return "not a patch";
+    case WM_DELTA_ERR_VERSION:   return "unsupported patch version";
+    case WM_DELTA_ERR_BASE:      return "patch is for another firmware";
+    case WM_DELTA_ERR_RANGE:     return "patch op out of range";
+    case WM_DELTA_ERR_READ:      return "old image read failed";
+    case WM_DELTA_ERR_WRITE:     return "new image write failed";
+    case WM_DELTA_ERR_TRUNCATED: return "patch truncated";
+    case WM_DELTA_ERR_TRAILING:  return "data after patch end";
+    case WM_DELTA_ERR_CRC:       return "new image crc mismatch";
+  }
+  return "?";
+}
+
+// header complete, checks it and that the running image is the one the patch was made from
+wm_delta_err_t WMDelta::header(){
+  if (!isPatch(_hdr, WM_DELTA_HDRSIZE)) return fail(WM_DELTA_ERR_MAGIC);
+  if (_hdr[4] != WM_DELTA_VERSION) return fail(WM_DELTA_ERR_VERSION);
+  _oldSize = le32(_hdr + 8);
+  _newSize = le32(_hdr + 16);
+  _newCrc  = le32(_hdr + 20);
+  uint32_t crc = 0;
+  for (uint32_t off = 0; off < _oldSize;) {
+    size_t n = lesser((uint32_t)WM_DELTA_WINDOW, _oldSize - off);
+    if (!_read(_ctx, off, _win, n)) return fail(WM_DELTA_ERR_READ);
+    crc = crc32(crc, _win, n);
+    off += n;
+  }
+  if (crc != le32(_hdr + 12)) return fail(WM_DELTA_ERR_BASE);
+  _state = _newSize ? S_OP : S_DONE;
+  return WM_DELTA_OK;
+}
+
+wm_delta_err_t WMDelta::op(uint8_t code, uint32_t n){
+  if (code == WM_DELTA_SEEK) {
+    int64_t to = (int64_t)_src + (int64_t)((n >> 1) ^ -(int64_t)(n & 1)); // zigzag
+    if (to < 0 || to > _oldSize) return fail(WM_DELTA_ERR_RANGE);
+    _src = (uint32_t)to;
+    return WM_DELTA_OK;
+  }
+  if (n > _newSize - _out) return fail(WM_DELTA_ERR_RANGE);
+  if (code != WM_DELTA_LIT && n > _oldSize - _src) return fail(WM_DELTA_ERR_RANGE);
+  if (code == WM_DELTA_COPY) {
+    if (copy(n) != WM_DELTA_OK) return _err;
+    if (_out == _newSize) _state = S_DONE;
+  }
+  else if (n) {
+    _op    = code;
+    _left  = n;
+    _state = S_DATA;
+  }
+  return WM_DELTA_OK;
+}
+
+// COPY needs no patch bytes, it runs to completion here a window at a time
+wm_delta_err_t WMDelta::copy(uint32_t n){
+  while (n) {
+    size_t c = lesser((uint32_t)WM_DELTA_WINDOW, n);
+    if (!_read(_ctx, _src, _win, c)) return fail(WM_DELTA_ERR_READ);
+    if (!emit(_win, c)) return fail(WM_DELTA_ERR_WRITE);
+    _src += c;
+    n    -= c;
+  }
+  return WM_DELTA_OK;
+}
+
+bool WMDelta::emit(const uint8_t *buf, size_t len){
+  _crc  = crc32(_crc, buf, len);
+  _out += len;
+  return _write(_ctx, buf, len);
+}
@@ -0,0 +1,118 @@
+/**
+ * wm_delta.h
+ *
+ * streaming decoder for delta ota patches, made by extras/wm_mkpatch.py
+ * the new image is rebuilt from the running one while the patch is uploaded
+ *
+ * no arduino dependencies, the old image and the output are reached through callbacks
+ *
+ * @license MIT
+ */
+
+#ifndef _WM_DELTA_H_
+#define _WM_DELTA_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * patch format, all integers little endian
+ *
+ * header, WM_DELTA_HDRSIZE bytes
+ *   "WMDP"  magic
+ *   u8      version, WM_DELTA_VERSION
+ *   u8[3]   reserved, 0
+ *   u32     old size, u32 crc32 of the old image
+ *   u32     new size, u32 crc32 of the new image
+ *
+ * ops until new size bytes were produced, each starts with a varint v, op = v & 3, n = v >> 2
+ *   COPY  n   n bytes of the old image at the source cursor, cursor += n
+ *   DIFF  n   n patch bytes, each added (mod 256) to the old byte at the cursor, cursor += n
+ *   LIT   n   n patch bytes copied as is
+ *   SEEK  n   cursor += zigzag decoded n
+ *
+ * relocated code mostly differs from the old image in a few pointer bytes, so it becomes
+ * short DIFF runs between long COPY runs and the patch stays a fraction of the image
+ */
+#define WM_DELTA_MAGIC   "WMDP"
+#define WM_DELTA_VERSION 1
+#define WM_DELTA_HDRSIZE 24
+
+#ifndef WM_DELTA_WINDOW
+    #define WM_DELTA_WINDOW 256 // old image bytes read at a time, the only buffer
+#endif
+
+enum wm_delta_op_t {
+  WM_DELTA_COPY = 0,
+  WM_DELTA_DIFF = 1,
+  WM_DELTA_LIT  = 2,
+  WM_DELTA_SEEK = 3
+};
+
+enum wm_delta_err_t {
+  WM_DELTA_OK = 0,
+  WM_DELTA_ERR_MAGIC,     // not a patch
+  WM_DELTA_ERR_VERSION,   // made by a newer generator
+  WM_DELTA_ERR_BASE,      // made against another image than the running one
+  WM_DELTA_ERR_RANGE,     // op reads outside the old image or writes past the new size
+  WM_DELTA_ERR_READ,      // old image read failed
+  WM_DELTA_ERR_WRITE,     // output sink failed
+  WM_DELTA_ERR_TRUNCATED, // patch ended early
+  WM_DELTA_ERR_TRAILING,  // bytes after the last op
+  WM_DELTA_ERR_CRC        // new image doesn't match its crc
+};
+
+// reads len bytes of the old image at off, false on error
+typedef bool (*wm_delta_read_t)(void *ctx, uint32_t off, uint8_t *buf, size_t len);
+// takes len bytes of the new image, false on error
+typedef bool (*wm_delta_write_t)(void *ctx, const uint8_t *buf, size_t len);
+
+class WMDelta {
+  public:
+    // true if data starts with the patch magic, needs at least 4 bytes
+    static bool     isPatch(const uint8_t *data, size_t len);
+    static uint32_t crc32(uint32_t crc, const uint8_t *data, size_t len);
+
+    void            begin(wm_delta_read_t read, wm_delta_write_t write, void *ctx);
+    // decodes the next part of the patch, any split is fine, errors stick
+    wm_delta_err_t  feed(const uint8_t *data, size_t len);
+    // after the last feed, checks the patch was complete and the new image crc
+    wm_delta_err_t  end();
+
+    wm_delta_err_t  error() const    { return _err; }
+    const char*     errorString() const { return errorString(_err); }
+    static const char* errorString(wm_delta_err_t err);
+    uint32_t        newSize() const  { return _newSize; }
+    uint32_t        produced() const { return _out; }
+
+  private:
+    enum state_t { S_HEADER, S_OP, S_DATA, S_DONE };
+
+    wm_delta_err_t  fail(wm_delta_err_t err) { _err = err; return err; }
+    wm_delta_err_t  header();
+    wm_delta_err_t  op(uint8_t code, uint32_t n);
+    wm_delta_err_t  copy(uint32_t n);
+    bool            emit(const uint8_t *buf, size_t len);
+
+    wm_delta_read_t  _read  = nullptr;
+    wm_delta_write_t _write = nullptr;
+    void*            _ctx   = nullptr;
+
+    state_t          _state = S_HEADER;
+    wm_delta_err_t   _err   = WM_DELTA_OK;
+    uint8_t          _hdr[WM_DELTA_HDRSIZE];
+    uint8_t          _hdrLen   = 0;
+    uint64_t         _varint   = 0;  // op being read
+    uint8_t          _shift    = 0;
+    uint8_t          _op       = 0;  // op whose data is being read
+    uint32_t         _left     = 0;  // data bytes left of it
+    uint32_t         _src      = 0;  // source cursor in the old image
+    uint32_t         _oldSize  = 0;
+    uint32_t         _newSize  = 0;
+    uint32_t         _newCrc   = 0;
+    uint32_t         _out      = 0;  // new image bytes produced
+    uint32_t         _crc      = 0;  // running crc32 of them
+    uint8_t          _win[WM_DELTA_WINDOW];
+};
+
+#endif
@@ -0,0 +1,118 @@
+/**
+ * wm_dns.cpp
+ *
+ * captive portal dns responder, see wm_dns.h
+ *
+ * Responses are built in the receive buffer: the header gets fixed flags and counts, the
+ * question stays where it is and a prebuilt answer pointing back at it (0xC00C) is appended,
+ * so nothing but the id and question travels from query to answer. AAAA, HTTPS and any other
+ * type get an immediate NOERROR without answers, phones then settle on the A record instead of
+ * waiting for a timeout.
+ *
+ * @license MIT
+ */
+
+#include "wm_dns.h"
+#include <lwip/sockets.h>
+
+#define DNS_HEADER   12
+#define DNS_TYPE_A   1
+#define DNS_CLASS_IN 1
+#define DNS_ANY      255
+#define DNS_NOTIMP   4
+
+bool WMDNSResponder::start(const uint16_t &port, const String &domainName, const IPAddress &resolvedIP){
+  stop();
+  const uint8_t answer[16] = {
+    0xC0, DNS_HEADER,                        // name, pointer to the question
+    0x00, DNS_TYPE_A, 0x00, DNS_CLASS_IN,
+    (uint8_t)(WM_DNS_TTL >> 24), (uint8_t)(WM_DNS_TTL >> 16), (uint8_t)(WM_DNS_TTL >> 8), (uint8_t)WM_DNS_TTL,
+    0x00, 0x04,                              // rdlength
+    resolvedIP[0], resolvedIP[1], resolvedIP[2], resolvedIP[3]
+  };
+  memcpy(_answer, answer, sizeof(_answer));
+
+  _fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if(_fd < 0) return false;
+  struct sockaddr_in addr = {};
+  addr.sin_family      = AF_INET;
+  addr.sin_port        = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  if(bind(_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0){
+    stop();
+    return false;
+  }
+  fcntl(_fd, F_SETFL, fcntl(_fd, F_GETFL, 0) | O_NONBLOCK);
+  return true;
+}
+
+void WMDNSResponder::stop(){
+  if(_fd < 0) return;
+  close(_fd);
+  _fd = -1;
+}
+
+void WMDNSResponder::processNextRequest(){
+  if(_fd < 0) return;
+  for(int i = 0; i < WM_DNS_BATCH; i++){
+    struct sockaddr_in from;
+    socklen_t fromlen = sizeof(from);
+    int len = recvfrom(_fd, _buf, sizeof(_buf), MSG_DONTWAIT, (struct sockaddr*)&from, &fromlen);
+    if(len <= 0) break; // drained
+    len = respond(_buf, len);
+    if(len > 0) sendto(_fd, _buf, len, MSG_DONTWAIT, (struct sockaddr*)&from, fromlen);
+  }
+}
+
+// turns the query in pkt into its response, returns the response length or 0 to drop it
+int WMDNSResponder::respond(uint8_t *pkt, int len){
+  if(len < DNS_HEADER || (pkt[2] & 0x80)){ // short or a response
+    _dropped++;
+    return 0;
+  }
+  uint8_t rd = pkt[2] & 0x01;
+  if(pkt[2] & 0x78){
+    // not a standard query, header only
+    pkt[2] = 0x80 | (pkt[2] & 0x78) | rd;
+    pkt[3] = DNS_NOTIMP;
+    memset(pkt + 4, 0, 8);
+    _dropped++;
+    return DNS_HEADER;
+  }
+  if(pkt[4] != 0 || pkt[5] != 1){ // one question, what every resolver sends
+    _dropped++;
+    return 0;
+  }
+
+  // walk the question name, labels only, compression is not valid here
+  int o = DNS_HEADER;
+  while(o < len && pkt[o] != 0){
+    if(pkt[o] & 0xC0){
+      _dropped++;
+      return 0;
+    }
+    o += pkt[o] + 1;
+  }
+  o++;
+  if(o + 4 > len || o - DNS_HEADER > 255){ // cut off, or a name no resolver sends, the answer must still fit
+    _dropped++;
+    return 0;
+  }
+  uint16_t qtype  = (pkt[o] << 8) | pkt[o + 1];
+  uint16_t qclass = (pkt[o + 2] << 8) | pkt[o + 3];
+  o += 4; // end of question, any edns record after it is dropped
+
+  bool a = (qtype == DNS_TYPE_A || qtype == DNS_ANY) && (qclass == DNS_CLASS_IN || qclass == DNS_ANY);
+  pkt[2]  = 0x84 | rd; // response, authoritative
+  pkt[3]  = 0x00;      // NOERROR, NODATA when there is no answer
+  pkt[6]  = 0x00;
+  pkt[7]  = a ? 1 : 0; // answers
+  memset(pkt + 8, 0, 4); // no authority or additional records
+  if(!a){
+    _negative++;
+    return o;
+  }
+  memcpy(pkt + o, _answer, sizeof(_answer));
+  _answered++;
+  return o + sizeof(_answer);
+}
@@ -0,0 +1,49 @@
+/**
+ * wm_dns.h
+ *
+ * captive portal dns responder, answers every A query with the soft AP ip
+ * drop in for DNSServer as used by WiFiManager: start(), processNextRequest(), stop()
+ *
+ * @license MIT
+ */
+
+#ifndef _WM_DNS_H_
+#define _WM_DNS_H_
+
+#include <Arduino.h>
+#include <IPAddress.h>
+
+#ifndef WM_DNS_TTL
+    #define WM_DNS_TTL 60 // s, answers only live as long as the portal
+#endif
+#define WM_DNS_MAXPACKET 512 // plain udp dns limit, larger (edns) queries are cut to their question
+#define WM_DNS_BATCH     32  // datagrams per processNextRequest, bounds one wakeup
+
+class WMDNSResponder {
+  public:
+    ~WMDNSResponder() { stop(); }
+
+    // binds the udp port, every name resolves to resolvedIP, domainName is only "*"
+    bool     start(const uint16_t &port, const String &domainName, const IPAddress &resolvedIP);
+    void     stop();
+    // answers every query waiting on the socket, never blocks
+    void     processNextRequest();
+    // socket to wait on, -1 when stopped
+    int      fd() const { return _fd; }
+
+    uint32_t answered() const { return _answered; } // A answers
+    uint32_t negative() const { return _negative; } // NODATA for AAAA, HTTPS and other types
+    uint32_t dropped()  const { return _dropped; }  // malformed or not a query
+
+  private:
+    int      respond(uint8_t *pkt, int len);
+
+    int      _fd = -1;
+    uint8_t  _answer[16];   // A record for the question name, built once in start()
+    uint32_t _answered = 0;
+    uint32_t _negative = 0;
+    uint32_t _dropped  = 0;
+    uint8_t  _buf[WM_DNS_MAXPACKET];
+};
+
+#endif
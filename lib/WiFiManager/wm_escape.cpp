@@ -0,0 +1,72 @@
+/**
+ * wm_escape.cpp
+ *
+ * html escaper, see wm_escape.h
+ *
+ * @license MIT
+ */
+
+#include "wm_escape.h"
+#include <string.h>
+
+/**
+ * escape entity for a single char, single pass escaper table
+ * @param  c          char to escape
+ * @param  whitespace text context, also encode spaces as nbsp
+ * @return entity or NULL if c is emitted as is
+ */
+static const char* htmlEscapeEntity(char c, bool whitespace){
+  switch(c){
+    case '&': return "&amp;";
+    case '<': return "&lt;";
+    case '>': return "&gt;";
+    case '\'': return "&#39;";
+    case '"': return whitespace ? NULL : "&quot;"; // either quote may delimit an attribute
+    case ' ': return whitespace ? "&#160;" : NULL;
+    // case '-': return "&ndash;";
+  }
+  return NULL;
+}
+
+/**
+ * size of str once escaped, excluding null term
+ * @param  str        string to escape
+ * @param  ctx        WM_ESC_ATTR attribute value, WM_ESC_TEXT html text (spaces to nbsp)
+ * @return escaped length
+ */
+size_t wmEscapeLen(const char *str, wm_escape_t ctx){
+  size_t len = 0;
+  for(; *str; str++){
+    const char *ent = htmlEscapeEntity(*str, ctx == WM_ESC_TEXT);
+    len += ent ? strlen(ent) : 1;
+  }
+  return len;
+}
+
+/**
+ * escape str into buf in one pass, never splits an entity
+ * @param  buf   output buffer, always null terminated
+ * @param  size  size of buf, wmEscapeLen()+1 for no truncation
+ * @param  str   string to escape
+ * @param  ctx   WM_ESC_ATTR attribute value, WM_ESC_TEXT html text (spaces to nbsp)
+ * @return bytes written excluding null term
+ */
+size_t wmEscape(char *buf, size_t size, const char *str, wm_escape_t ctx){
+  if(!size) return 0;
+  char *out = buf;
+  char *end = buf + size - 1;
+  for(; *str; str++){
+    const char *ent = htmlEscapeEntity(*str, ctx == WM_ESC_TEXT);
+    if(!ent){
+      if(out == end) break;
+      *out++ = *str;
+      continue;
+    }
+    size_t n = strlen(ent);
+    if((size_t)(end - out) < n) break;
+    memcpy(out, ent, n);
+    out += n;
+  }
+  *out = '\0';
+  return out - buf;
+}
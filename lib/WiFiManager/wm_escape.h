@@ -0,0 +1,31 @@
+/**
+ * wm_escape.h
+ *
+ * single pass html escaper writing into a caller buffer
+ *
+ * no arduino dependencies, WiFiManager::htmlEscape and htmlEntities are built on it
+ *
+ * @license MIT
+ */
+
+#ifndef _WM_ESCAPE_H_
+#define _WM_ESCAPE_H_
+
+#include <stddef.h>
+
+// html escape contexts
+typedef enum {
+    WM_ESC_ATTR = 0, // attribute value, either quote and markup
+    WM_ESC_TEXT = 1  // html text, also spaces to nbsp
+} wm_escape_t;
+
+#ifndef WM_ESCAPE_BUFSIZE
+#define WM_ESCAPE_BUFSIZE (32*6+1)// worst case escaped ssid, every char a 6 byte entity
+#endif
+
+// size of str once escaped, excluding null term
+size_t wmEscapeLen(const char *str, wm_escape_t ctx);
+// escapes str into buf, always null terminated and never splits an entity, returns bytes written
+size_t wmEscape(char *buf, size_t size, const char *str, wm_escape_t ctx);
+
+#endif
@@ -0,0 +1,108 @@
+#include "api.h"
+#include "jsonwriter.h"
+#include "timesync.h"
+#include "display.h"
+#include "modes.h"
+#include "zerocross.h"
+#include "sse.h"
+#include "settings.h"
+#include <esp_heap_caps.h>
+
+static const char JSON_TYPE[] PROGMEM = "application/json";
+
+static WiFiManager *wm = nullptr;
+static char apiBuf[API_BUF_SIZE];
+
+static void send(int code, const JsonWriter &json) {
+  if (json.overflow()) {
+    wm->server->send_P(500, JSON_TYPE, "{\"error\":\"overflow\"}");
+    return;
+  }
+  wm->server->send_P(code, JSON_TYPE, json.c_str(), json.length());
+}
+
+static void writeConfig(JsonWriter &json) {
+  json.num("brightness", (int64_t)displayBrightness());
+  json.str("tz", timeZone());
+}
+
+static void handleStatus() {
+  time_t now = time(nullptr);
+  struct tm lt;
+  localtime_r(&now, &lt);
+  char local[20];
+  strftime(local, sizeof(local), "%Y-%m-%dT%H:%M:%S", &lt);
+  const time_sync_t &sync = timeSyncStats();
+
+  JsonWriter json(apiBuf, sizeof(apiBuf));
+  json.beginObject();
+  json.num("time", (int64_t)now);
+  json.str("local", local);
+  json.beginObject("sync");
+  json.boolean("ok", sync.count > 0);
+  json.num("count", (int64_t)sync.count);
+  json.num("last", (int64_t)sync.last);
+  json.num("age", sync.count ? (int64_t)(now - sync.last) : (int64_t)-1);
+  json.num("offset_us", sync.offsetUs);
+  json.num("drift_ppm", sync.driftPpm, 2);
+  json.endObject();
+  json.num("uptime", esp_timer_get_time() / 1000000);
+  json.beginObject("heap");
+  json.num("free", (int64_t)ESP.getFreeHeap());
+  json.num("min", (int64_t)ESP.getMinFreeHeap());
+  json.num("max_block", (int64_t)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+  json.endObject();
+  json.str("mode", modeName(modeCurrent()));
+  json.num("mains_hz", zcFrequency(), 2);
+  json.boolean("mains_locked", zcLocked());
+  writeConfig(json);
+  json.endObject();
+  send(200, json);
+}
+
+//GET returns the config, POST applies the given form fields live and returns the result
+static void handleConfig() {
+  WebServer &server = *wm->server;
+  JsonWriter json(apiBuf, sizeof(apiBuf));
+  if (server.method() == HTTP_POST) {
+    //validated, stored and applied as one change
+    settings_t next = settings();
+    const char *error = nullptr;
+    if (server.hasArg(F("brightness"))) {
+      //toInt() reads "abc" as 0, only a whole number is taken
+      String arg = server.arg(F("brightness"));
+      char *end;
+      long level = strtol(arg.c_str(), &end, 10);
+      if (end == arg.c_str() || *end || level < 0 || level > DISPLAY_BRIGHT_MAX) {
+        error = "brightness out of range";
+      }
+      next.brightness = level;
+    }
+    if (!error && server.hasArg(F("tz"))) {
+      if (strlcpy(next.tz, server.arg(F("tz")).c_str(), sizeof(next.tz)) >= sizeof(next.tz)) {
+        error = "tz too long";
+      }
+    }
+    if (!error) {
+      error = settingsApply(next);
+    }
+    if (error) {
+      json.beginObject().str("error", error).endObject();
+      send(400, json);
+      return;
+    }
+  }
+  json.beginObject();
+  writeConfig(json);
+  json.endObject();
+  send(200, json);
+}
+
+void apiBegin(WiFiManager &manager) {
+  wm = &manager;
+  manager.setWebServerCallback([]() {
+    wm->server->on(F("/api/status"), HTTP_GET, handleStatus);
+    wm->server->on(F("/api/config"), handleConfig);
+    sseRoutes(*wm->server);
+  });
+}
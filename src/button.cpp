@@ -0,0 +1,126 @@
+#include "button.h"
+#include "power.h"
+#include <freertos/timers.h>
+#include <freertos/queue.h>
+#include <esp_timer.h>
+
+static uint8_t buttonPin;
+static bool buttonActiveHigh;
+static QueueHandle_t buttonQueue;
+static TimerHandle_t debounceTimer; // restarted by every edge, fires once the line is quiet
+static TimerHandle_t holdTimer;     // started on press
+static TimerHandle_t clickTimer;    // started on release, closes the double click window
+
+//ISR -> timer task handoff of the first edge time of a bounce burst
+static portMUX_TYPE edgeMux = portMUX_INITIALIZER_UNLOCKED;
+static volatile int64_t edgeUs = 0;
+static volatile bool bouncing = false;
+
+//Gesture state, only touched from the timer task so no locking needed
+static volatile bool stable = false; // debounced pressed state
+static bool held = false;            // hold fired for the current press
+static bool doublePress = false;     // current press was the second of a double click
+static bool clickPending = false;    // released, waiting for the double click window
+static int64_t releaseUs = 0;
+
+static void post(button_gesture_t gesture, int64_t us) {
+  button_event_t ev = {gesture, us};
+  xQueueSend(buttonQueue, &ev, 0); // never block the timer task, drop when nobody listens
+}
+
+static void IRAM_ATTR buttonISR() {
+  powerRearm(buttonPin);
+  BaseType_t woken = pdFALSE;
+  portENTER_CRITICAL_ISR(&edgeMux);
+  if (!bouncing) {
+    bouncing = true;
+    edgeUs = esp_timer_get_time();
+  }
+  portEXIT_CRITICAL_ISR(&edgeMux);
+  xTimerResetFromISR(debounceTimer, &woken);
+  if (woken) {
+    portYIELD_FROM_ISR();
+  }
+}
+
+static void onDebounce(TimerHandle_t) {
+  portENTER_CRITICAL(&edgeMux);
+  int64_t us = edgeUs;
+  bouncing = false;
+  portEXIT_CRITICAL(&edgeMux);
+
+  bool pressed = (digitalRead(buttonPin) == HIGH) == buttonActiveHigh;
+  if (pressed == stable) {
+    return; // glitch, level came back
+  }
+  stable = pressed;
+
+  if (pressed) {
+    held = false;
+    doublePress = clickPending && (us - releaseUs) <= (int64_t)BTN_DOUBLE_MS * 1000;
+    clickPending = false;
+    xTimerStop(clickTimer, 0);
+    post(BTN_DOWN, us);
+    if (doublePress) {
+      post(BTN_DOUBLE, us);
+    }
+    xTimerStart(holdTimer, 0);
+  }
+  else {
+    xTimerStop(holdTimer, 0);
+    post(BTN_UP, us);
+    if (held) {
+      post(BTN_HOLD_RELEASE, us);
+    }
+    else if (!doublePress) {
+      //single press so far, becomes a click if no second press follows
+      clickPending = true;
+      releaseUs = us;
+      xTimerStart(clickTimer, 0);
+    }
+  }
+}
+
+static void onHold(TimerHandle_t) {
+  if (stable) {
+    held = true;
+    post(BTN_HOLD, esp_timer_get_time());
+  }
+}
+
+static void onClick(TimerHandle_t) {
+  if (clickPending) {
+    clickPending = false;
+    post(BTN_CLICK, releaseUs);
+  }
+}
+
+void buttonBegin(uint8_t pin, bool activeHigh) {
+  buttonPin = pin;
+  buttonActiveHigh = activeHigh;
+  buttonQueue = xQueueCreate(BTN_QUEUE_LEN, sizeof(button_event_t));
+  debounceTimer = xTimerCreate("btnDeb", pdMS_TO_TICKS(BTN_DEBOUNCE_MS), pdFALSE, nullptr, onDebounce);
+  holdTimer = xTimerCreate("btnHold", pdMS_TO_TICKS(BTN_HOLD_MS), pdFALSE, nullptr, onHold);
+  clickTimer = xTimerCreate("btnClick", pdMS_TO_TICKS(BTN_DOUBLE_MS), pdFALSE, nullptr, onClick);
+  pinMode(pin, INPUT);
+  stable = (digitalRead(pin) == HIGH) == activeHigh;
+  //level interrupt flipped on every edge, so a touch also wakes from light sleep
+  powerAttachWake(pin, buttonISR);
+}
+
+bool buttonGetEvent(button_event_t &ev, TickType_t wait) {
+  return xQueueReceive(buttonQueue, &ev, wait) == pdTRUE;
+}
+
+bool buttonWait(TickType_t wait) {
+  button_event_t ev;
+  return xQueuePeek(buttonQueue, &ev, wait) == pdTRUE;
+}
+
+bool buttonPressed() {
+  return stable;
+}
+
+void buttonFlush() {
+  xQueueReset(buttonQueue);
+}
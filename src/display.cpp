@@ -0,0 +1,126 @@
+#include "display.h"
+#include "taskstats.h"
+#include "profiler.h"
+#include "zerocross.h"
+#include <ShiftRegister74HC595.h>
+#include <atomic>
+#include <esp_timer.h>
+
+const int numberOfShiftRegisters = 4; // number of shift registers attached in series
+const int serialDataPin = DISPLAY_DATA_PIN;
+const int clockPin = DISPLAY_CLOCK_PIN;
+const int latchPin = DISPLAY_LATCH_PIN;
+ShiftRegister74HC595<numberOfShiftRegisters> sr(serialDataPin, clockPin, latchPin);
+
+//Bytes shifted out by the ISR, one array per zero cross phase, double buffered
+//so the ISR never sees half a frame. The display task fills the back buffer and flips.
+static uint8_t PinValues_T[2][4];
+static uint8_t PinValues_U[2][4];
+static volatile uint8_t front = 0;
+static const uint8_t blank[4] = {0,0,0,0};
+static volatile uint8_t brightness = DISPLAY_BRIGHT_MAX;
+
+//Single producer (mode task), single consumer (display task) frame ring
+static frame_t ring[DISPLAY_RING_LEN];
+static std::atomic<uint32_t> ringHead(0); // written by the producer
+static std::atomic<uint32_t> ringTail(0); // written by the consumer
+static uint32_t dropped = 0;
+
+static frame_t posted;  // last frame accepted by displayPost, producer side
+static TaskHandle_t displayTask = nullptr;
+static int displaySlot = -1;
+static void (*onCommit)(const frame_t &frame) = nullptr;
+
+//Phase switch, called by the zero cross PLL from its edge or timer ISR
+static void IRAM_ATTR ISR(bool high) {
+  PROF_SCOPE(PROF_ISR);
+  uint8_t f = front;
+  if (!brightness) {
+    sr.setAll(blank);
+  }
+  else if(!high) {
+    sr.setAll(PinValues_U[f]);
+  }
+  else {
+    sr.setAll(PinValues_T[f]);
+  }
+}
+
+//End of the lit part of a dimmed half wave, called by the PLL like ISR
+static void IRAM_ATTR blankISR() {
+  sr.setAll(blank);
+}
+
+//Splits 32 bit word into 8but words for the shift regsiter library
+static void commit(const frame_t &frame) {
+  uint8_t back = !front;
+  for (int i = 0; i <= 3;i++) {
+      PinValues_T[back][i] = (frame.a >> (i)*8) & 0xFF;
+      PinValues_U[back][i] = (frame.b >> (i)*8) & 0xFF;
+  }
+  front = back;
+}
+
+//Commits frames as soon as they are posted, only the newest one of a burst reaches the tubes
+static void displayLoop(void *) {
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    int64_t start = esp_timer_get_time();
+    uint32_t tail = ringTail.load(std::memory_order_relaxed);
+    uint32_t head = ringHead.load(std::memory_order_acquire);
+    if (head != tail) {
+      const frame_t &frame = ring[(head - 1) % DISPLAY_RING_LEN];
+      commit(frame);
+      if (onCommit) {
+        onCommit(frame);
+      }
+      ringTail.store(head, std::memory_order_release);
+    }
+    taskBusy(displaySlot, esp_timer_get_time() - start);
+  }
+}
+
+void displayBegin(uint8_t zcPin) {
+  //Shift Register
+  pinMode(serialDataPin, OUTPUT);
+  pinMode(clockPin, OUTPUT);
+  pinMode(latchPin, OUTPUT);
+  //Interrupt (ZeroCross detection)
+  zcBegin(zcPin, ISR, blankISR);
+  xTaskCreate(displayLoop, "display", 2048, nullptr, TASK_PRIO_DISPLAY, &displayTask);
+  displaySlot = taskStatsAdd("display", displayTask);
+}
+
+bool displayPost(const frame_t &frame) {
+  uint32_t head = ringHead.load(std::memory_order_relaxed);
+  if (head - ringTail.load(std::memory_order_acquire) >= DISPLAY_RING_LEN) {
+    dropped++;
+    return false;
+  }
+  ring[head % DISPLAY_RING_LEN] = frame;
+  ringHead.store(head + 1, std::memory_order_release);
+  posted = frame;
+  xTaskNotifyGive(displayTask);
+  return true;
+}
+
+const frame_t &displayFrame() {
+  return posted;
+}
+
+uint32_t displayDropped() {
+  return dropped;
+}
+
+void displayOnCommit(void (*cb)(const frame_t &frame)) {
+  onCommit = cb;
+}
+
+void displaySetBrightness(uint8_t level) {
+  brightness = level > DISPLAY_BRIGHT_MAX ? DISPLAY_BRIGHT_MAX : level;
+  zcSetLit(brightness * ZC_LIT_FULL / DISPLAY_BRIGHT_MAX);
+}
+
+uint8_t displayBrightness() {
+  return brightness;
+}
@@ -0,0 +1,147 @@
+#include "jsonwriter.h"
+#include <cmath>
+
+JsonWriter::JsonWriter(char *buf, size_t size) : _buf(buf), _size(size) {
+  if (size) {
+    buf[0] = '\0';
+  }
+}
+
+void JsonWriter::raw(const char *s, size_t n) {
+  if (_overflow || !_size) {
+    _overflow = true;
+    return;
+  }
+  if (_len + n >= _size) {
+    n = _size - 1 - _len;
+    _overflow = true;
+  }
+  memcpy(_buf + _len, s, n);
+  _len += n;
+  _buf[_len] = '\0';
+}
+
+void JsonWriter::quoted(const char *s) {
+  raw("\"", 1);
+  //copy runs of plain characters at once, escape the rest
+  const char *run = s;
+  for (; *s; s++) {
+    unsigned char c = *s;
+    if (c >= 0x20 && c != '"' && c != '\\') {
+      continue;
+    }
+    raw(run, s - run);
+    run = s + 1;
+    char esc[7];
+    switch (c) {
+      case '"':  raw("\\\"", 2); break;
+      case '\\': raw("\\\\", 2); break;
+      case '\n': raw("\\n", 2); break;
+      case '\r': raw("\\r", 2); break;
+      case '\t': raw("\\t", 2); break;
+      default:
+        snprintf(esc, sizeof(esc), "\\u%04x", c);
+        raw(esc, 6);
+    }
+  }
+  raw(run, s - run);
+  raw("\"", 1);
+}
+
+void JsonWriter::key(const char *k) {
+  uint32_t bit = 1UL << _depth;
+  if (!(_first & bit)) {
+    raw(",", 1);
+  }
+  _first &= ~bit;
+  if (_depth && !(_array & bit) && k) {
+    quoted(k);
+    raw(":", 1);
+  }
+}
+
+JsonWriter &JsonWriter::beginObject(const char *k) {
+  key(k);
+  raw("{", 1);
+  if (_depth + 1 < JSON_MAX_DEPTH) {
+    _depth++;
+    _first |= 1UL << _depth;
+    _array &= ~(1UL << _depth);
+  }
+  else {
+    _overflow = true;
+  }
+  return *this;
+}
+
+JsonWriter &JsonWriter::endObject() {
+  raw("}", 1);
+  if (_depth) {
+    _depth--;
+  }
+  return *this;
+}
+
+JsonWriter &JsonWriter::beginArray(const char *k) {
+  key(k);
+  raw("[", 1);
+  if (_depth + 1 < JSON_MAX_DEPTH) {
+    _depth++;
+    _first |= 1UL << _depth;
+    _array |= 1UL << _depth;
+  }
+  else {
+    _overflow = true;
+  }
+  return *this;
+}
+
+JsonWriter &JsonWriter::endArray() {
+  raw("]", 1);
+  if (_depth) {
+    _depth--;
+  }
+  return *this;
+}
+
+JsonWriter &JsonWriter::str(const char *k, const char *value) {
+  key(k);
+  if (value) {
+    quoted(value);
+  }
+  else {
+    raw("null", 4);
+  }
+  return *this;
+}
+
+JsonWriter &JsonWriter::num(const char *k, int64_t value) {
+  key(k);
+  char tmp[21];
+  raw(tmp, snprintf(tmp, sizeof(tmp), "%lld", (long long)value));
+  return *this;
+}
+
+JsonWriter &JsonWriter::num(const char *k, double value, uint8_t decimals) {
+  key(k);
+  if (std::isnan(value) || std::isinf(value)) {
+    raw("null", 4); // not representable in JSON
+    return *this;
+  }
+  char tmp[32];
+  int n = snprintf(tmp, sizeof(tmp), "%.*f", decimals, value);
+  raw(tmp, n < (int)sizeof(tmp) ? n : sizeof(tmp) - 1);
+  return *this;
+}
+
+JsonWriter &JsonWriter::boolean(const char *k, bool value) {
+  key(k);
+  raw(value ? "true" : "false");
+  return *this;
+}
+
+JsonWriter &JsonWriter::null(const char *k) {
+  key(k);
+  raw("null", 4);
+  return *this;
+}
@@ -1,77 +1,69 @@
 #include <Arduino.h>
-#include <ShiftRegister74HC595.h>
 #include <WiFiManager.h>
 #include <Wifi.h>
 #include <time.h>
 #include <ESP32Time.h>
+#include "button.h"
+#include "display.h"
+#include "modes.h"
+#include "taskstats.h"
+#include "scheduler.h"
+#include "profiler.h"
+#include "zerocross.h"
+#include "power.h"
+#include "timesync.h"
+#include "api.h"
+#include "sse.h"
+#include "settings.h"
+#include <atomic>
 
-
-const int numberOfShiftRegisters = 4; // number of shift registers attached in series
-const int serialDataPin = 5; // DS
-const int clockPin = 7; // SHCP
-const int latchPin = 6; // STCP
-ShiftRegister74HC595<numberOfShiftRegisters> sr(serialDataPin, clockPin, latchPin);
-const int btn = 3; //Capacitive button
-
-uint32_t PinValuesA = 0b01000001000000000001000000000001;
-uint32_t PinValuesB = 0b01000010000000000010000000000010;
-/*
-00 987654 3210 9876 543210 98 76543210
-01 000001 0000 0000 000100 00 00000001
-01 000010 0000 0000 001000 00 00000010
-*/
-uint8_t PinValues_T[] = {0,0,0,0};
-uint8_t PinValues_U[] = {0,0,0,0};
-
-const int interruptPin = 10;
-
-unsigned long currentMillis = 0;
 unsigned long prevMillis = 0;
-unsigned int prevSec = 0;
-
-const char* ntpServer1 = "pool.ntp.org";
-const char* ntpServer2 = "time.nist.gov";
-const long  gmtOffset_sec = 3600;
-const int   daylightOffset_sec = 3600;
-
-uint32_t H_T,H_U,M_T,M_U,S_T,S_U = 0;
-uint32_t nixie[6] = {0,0,0,0,0,0};
+int prevSec = -1;
+
+//Scheduler tick stats, in us
+uint32_t tickLateMax = 0;
+uint32_t tickWorkMax = 0;
+uint64_t tickWorkSum = 0;
+uint32_t tickCount = 0;
+unsigned long statsMillis = 0;
+
+//Requests to the network task
+#define NET_RESYNC  (1 << 0)
+#define NET_SSE     (1 << 1) // frames queued for the event stream clients
+#define NET_ONLINE  (1 << 2) // resync connect got an ip
+#define NET_OFFLINE (1 << 3) // resync connect failed
+#define NET_SCANNED (1 << 4) // fallback scan done, the stored networks are ranked on it
+TaskHandle_t modeTask = nullptr;
+TaskHandle_t netTask = nullptr;
+int modeSlot = -1;
+int netSlot = -1;
+std::atomic<bool> resynced(false); // set by the net task, the mode task rebuilds the schedule
+uint8_t connectReason = 0;          // disconnect reason of the last failed resync
+//Resync fallback, the stored networks in range, tried one connect per NET_OFFLINE
+wm_cred_t fallbackTries[WM_CREDS_MAX];
+uint8_t fallbackCount = 0;
+uint8_t fallbackNext = 0;
+bool fallback = false;              // the saved network failed, the stored ones are being tried
 
 WiFiManager wifiManager;
 
-const char* timezone = "CET-1CEST,M3.5.0,M10.5.0/3";  // TimeZone rule for Europe/Rome including daylight adjustment rules (optional)
-
 ESP32Time rtc(0);
 
 struct tm timeinfo;
 
-void IRAM_ATTR ISR() {
-  if((digitalRead(interruptPin) == LOW)) {
-    sr.setAll(PinValues_U);
-  }
-  else {
-    sr.setAll(PinValues_T);
-  }  
-}
-
-void setTimezone(String timezone){
-  //Serial.printf("  Setting Timezone to %s\n",timezone.c_str());
-  setenv("TZ",timezone.c_str(),1);  //  Now adjust the TZ.  Clock settings are adjusted to show the new local time
-  tzset();
-}
-
-void initTime(String timezone){
+void initTime(){
+  const settings_t &cfg = settings();
   // struct tm timeinfo;
 
   // Serial.println("Setting up time");
-  configTime(gmtOffset_sec, daylightOffset_sec, ntpServer1, ntpServer2);    // First connect to NTP server, with 0 TZ offset
+  configTime(cfg.gmtOffset, cfg.dstOffset, cfg.ntp1, cfg.ntp2);    // First connect to NTP server, with 0 TZ offset
   if(!getLocalTime(&timeinfo)) {
     // Serial.println("  Failed to obtain time");
     return;
   }
   // Serial.println("  Got the time from NTP");
   // Now we can set the real timezone
-  setTimezone(timezone);
+  timeSetZone(cfg.tz);
 }
 
 void printLocalTime()
@@ -83,343 +75,235 @@ void printLocalTime()
   Serial.println(&timeinfo, "%A, %B %d %Y %H:%M:%S");
 }
 
-inline uint32_t bit_set(uint32_t vector, uint32_t n) {
-      return vector | ((uint32_t)1 << n);
-}
-inline uint32_t bit_clr(uint32_t vector, uint32_t n) {
-      return vector & ~((uint32_t)1 << n);
-}
-//Splits 32 bit word into 8but words for the shift regsiter library
-void loadShiftRegs(){
-  for (int i = 0; i <= 3;i++) {
-      PinValues_T[i] = (PinValuesA >> (i)*8) & 0xFF;
-      PinValues_U[i] = (PinValuesB >> (i)*8) & 0xFF;
-    }
-}
-//converts integers into a 32bit word, that controlls the actual nixie pins
-void loadPinRegs(bool zero = false){
-  //clear pins registers
-    PinValuesA = 0;
-    PinValuesB = 0;
-    //Load values to display correct digits
-    if (!zero) {
-      PinValuesA = bit_set(PinValuesA, nixie[5]);
-      PinValuesB = bit_set(PinValuesB, nixie[4]);
-      PinValuesA = bit_set(PinValuesA, nixie[3]+10);
-      PinValuesB = bit_set(PinValuesB, nixie[2]+10);
-      PinValuesA = bit_set(PinValuesA, nixie[1]+20);
-      PinValuesB = bit_set(PinValuesB, nixie[0]+20);
-    }
-    //load register values into bytes in PinValues arrays
-    //This is needed, because the ShiftReg library uses Byte arrays to load data
-    loadShiftRegs();
-}
-
-void setAllPins(int arg){
-  //clear pins registers
-    PinValuesA = 0;
-    PinValuesB = 0;
-    //Load values to display correct digits
-    PinValuesA = bit_set(PinValuesA, arg);
-    PinValuesB = bit_set(PinValuesB, arg);
-    PinValuesA = bit_set(PinValuesA, arg+10);
-    PinValuesB = bit_set(PinValuesB, arg+10);
-    PinValuesA = bit_set(PinValuesA, arg+20);
-    PinValuesB = bit_set(PinValuesB, arg+20);
-    //load register values into bytes in PinValues arrays
-    //This is needed, because the ShiftReg library uses Byte arrays to load data
-    loadShiftRegs();
-}
-
-void show_date() {
-  nixie[0] = ((timeinfo.tm_year + 1900) % 100) % 10;
-  nixie[1] = ((timeinfo.tm_year + 1900) % 100) / 10;
-  nixie[2] = (timeinfo.tm_mon + 1) % 10; // Month is zero-based, so adding 1
-  nixie[3] = (timeinfo.tm_mon + 1) / 10; // Month is zero-based, so adding 1
-  nixie[4] = timeinfo.tm_mday % 10;
-  nixie[5] = timeinfo.tm_mday / 10;
-  loadPinRegs();
+//Scheduled events, fired from the mode task
+void onSchedule(const sched_rule_t &rule) {
+  switch (rule.action) {
+    case SCHED_LIGHTSHOW:
+      if (modeCurrent() == MODE_CLOCK) {
+        modeSwitch(MODE_LIGHTSHOW);
+      }
+      break;
+    case SCHED_RESYNC:
+      //get atomic time, the network task does the blocking part
+      xTaskNotify(netTask, NET_RESYNC, eSetBits);
+      break;
+    case SCHED_ALARM:
+    case SCHED_COUNTDOWN:
+      modeSwitch(MODE_ALARM);
+      break;
+  }
 }
 
-void stopwatch() {
-  //stopwatch
-  memset(nixie, 0, sizeof(nixie));
-  loadPinRegs();
-  while(digitalRead(btn) == LOW) {} //wait for btn press
-  while(digitalRead(btn) == HIGH) {} //wait for btn depress
-  unsigned long startTime = millis();
-  while(digitalRead(btn) == LOW) {  //start stopwatch
-    unsigned long currentTime = millis(); // Get the current time
-
-    // Calculate elapsed time since the start time
-    unsigned long elapsedTime = currentTime - startTime;
-
-    // Calculate hundredths of a second, seconds, and minutes
-    unsigned int hundredths = (elapsedTime / 10) % 100;
-    unsigned int seconds = (elapsedTime / 1000) % 60;
-    unsigned int minutes = (elapsedTime / 60000) % 60;
-
-    // Extract units and tens digits
-    nixie[0] = hundredths % 10;      // Units digit of hundredths
-    nixie[1] = hundredths / 10;      // Tens digit of hundredths
-    nixie[2] = seconds % 10;         // Units digit of seconds
-    nixie[3] = seconds / 10;         // Tens digit of seconds
-    nixie[4] = minutes % 10;         // Units digit of minutes
-    nixie[5] = minutes / 10;         // Tens digit of minutes
-
-    loadPinRegs(); // Assuming this function updates the display
+//Prints tick lateness and work time and the per task stats once a minute
+void printTickStats() {
+  if (millis() - statsMillis < 60000) {
+    return;
   }
-  while(digitalRead(btn) == HIGH) {} //wait for btn depress
-  //wait for button press before jumping out of stopwatch mode
-  while(digitalRead(btn) == LOW) {} //wait for btn press
+  statsMillis = millis();
+  Serial.printf("tick: late max %luus, work max %luus avg %luus, mode %s, dropped %lu\n",
+                (unsigned long)tickLateMax, (unsigned long)tickWorkMax,
+                (unsigned long)(tickCount ? tickWorkSum / tickCount : 0), modeName(modeCurrent()),
+                (unsigned long)displayDropped());
+  Serial.printf("mains: %.2fHz %s, rejected %lu\n", zcFrequency(), zcLocked() ? "locked" : "unlocked",
+                (unsigned long)zcRejected());
+  tickLateMax = 0;
+  tickWorkMax = 0;
+  tickWorkSum = 0;
+  tickCount = 0;
+  taskStatsPrint(Serial);
+  powerStats(Serial);
 }
 
-void lightshow() {
-  //blink progresively faster
-  for (int i = 0; i < 20; i++) {
-    loadPinRegs(true);
-    delay(200-i*10);
-    loadPinRegs();
-    delay(200-i*10);
-  }
-  //blink fast for a bit
-  for (int i = 0; i < 10; i++) {
-    loadPinRegs(true);
-    delay(20);
-    loadPinRegs();
-    delay(20);
-  }
-  loadPinRegs(true);
-  delay(500);
-  //memset(nixie, 0, sizeof(nixie)); // zero out
-  //NUMBER WAVE
-  const int delay_wave = 30;
-  for (int l = 0; l < 9; l++) {
-    for (int i = 2; i >= 0; i--) {
-      PinValuesB = bit_set(PinValuesB, i*10+l);
-      loadShiftRegs(); 
-      delay(delay_wave);//50
-      PinValuesA = bit_set(PinValuesA, i*10+l);
-      loadShiftRegs();
-      delay(delay_wave); 
+//Timekeeping and modes, fixed rate tick, every mode gets one update per tick
+void modeLoop(void *) {
+  TickType_t lastWake = xTaskGetTickCount();
+  frame_t frame;
+  bool pending = false; // frame not yet accepted by the display task
+  while (true) {
+    if (modeIdle() && !pending) {
+      //nothing changes before the next second or a press, let the cpu sleep until then
+      powerModes(PWR_IDLE);
+      buttonWait(pdMS_TO_TICKS(1000 - rtc.getMillis() % 1000) + 1);
+      powerModes(PWR_TICK);
+      lastWake = xTaskGetTickCount();
     }
-    for (int i = 2; i >= 0; i--) {
-      PinValuesB = bit_clr(PinValuesB, i*10+l);
-      loadShiftRegs(); 
-      delay(delay_wave);
-      PinValuesA = bit_clr(PinValuesA, i*10+l);
-      loadShiftRegs();
-      delay(delay_wave); 
+    else {
+      vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(TICK_MS));
     }
-  }
-  //NUMBER PONG
-  const int delay_pong = 70;
-  for (int l = 9; l >= 0; l--) {
-    //shift number l from left to right
-    for (int i = 2; i >= 0; i--) {
-      PinValuesB = bit_set(PinValuesB, i*10+l);
-      loadShiftRegs(); 
-      delay(delay_pong);
-      PinValuesB = bit_clr(PinValuesB, i*10+l);
-      PinValuesA = bit_set(PinValuesA, i*10+l);
-      loadShiftRegs();
-      delay(delay_pong);
-      PinValuesA = bit_clr(PinValuesA, i*10+l); 
+    PROF_SCOPE(PROF_TICK);
+    int64_t wakeUs = esp_timer_get_time();
+    uint32_t lateUs = (xTaskGetTickCount() - lastWake) * portTICK_PERIOD_MS * 1000;
+    unsigned long currentMillis = millis();
+
+    //hand the button events to the current mode
+    button_event_t ev;
+    while (buttonGetEvent(ev)) {
+      modeEvent(ev, currentMillis);
     }
 
-    //shift the number l one to the right
-    PinValuesB = bit_set(PinValuesB, l);
-    loadShiftRegs();
-    delay(delay_pong);
-    PinValuesB = bit_clr(PinValuesB, l);
-
-    //shift the number l right to left
-    for (int i = 1; i <= 2; i++) {
-      PinValuesA = bit_set(PinValuesA, i*10+l);
-      loadShiftRegs(); 
-      delay(delay_pong);
-      PinValuesA = bit_clr(PinValuesA, i*10+l);
-      PinValuesB = bit_set(PinValuesB, i*10+l);
-      loadShiftRegs();
-      delay(delay_pong);
-      PinValuesB = bit_clr(PinValuesB, i*10+l); 
-    }
-  }
-  //SHIFT IN CURRENT TIME
-  const int delay_finish = 80;
-  int display_num = 0;
-  for (int l = 0; l <= 4; l++) {
-    //first shift in hours, then minutes, then seconds
-    switch (l) {
-      case 0:
-        display_num = timeinfo.tm_hour/10;
-        break;
-      case 1:
-        display_num = timeinfo.tm_hour%10;
-        break;
-      case 2:
-        display_num = timeinfo.tm_min/10;
-        break;
-      case 3:
-        display_num = timeinfo.tm_min%10;
-        break;
-      case 4:
-        display_num = timeinfo.tm_sec/10;
-        break;
-      default:
-        break;
-    }
-    
-    for (int i = 5; i >= l; i--) {
-      /*
-      This loop index runs from 5 to l, instead of from 2 to 0 as in the previous effect.
-      This value is responsible for selecting the correct 10x range in PinValues,
-      i.e. selecting the correct pair of nixies.
-      */
-      int sel_digits = (i/2)*10;
-      if (i%2 == 1) {
-        PinValuesB = bit_set(PinValuesB, sel_digits+display_num);
-        loadShiftRegs();
-        delay(delay_finish);
-        if (i > l) { //clear the bit except for the last cycle, i.e. keep the shifted digits visible
-          PinValuesB = bit_clr(PinValuesB, sel_digits+display_num);
-        }
+    //get time from rtc every 50ms
+    if ((currentMillis - prevMillis >= 50)) {
+      prevMillis = currentMillis;
+      {
+        PROF_SCOPE(PROF_TIMEREAD);
+        timeinfo = rtc.getTimeStruct();
       }
-      if (i%2 == 0) {
-        PinValuesA = bit_set(PinValuesA, sel_digits+display_num);
-        loadShiftRegs();
-        delay(delay_finish);
-        if (i > l) { //clear the bit except for the last cycle, i.e. keep the shifted digits visible
-          PinValuesA = bit_clr(PinValuesA, sel_digits+display_num);
-        }
+      if (resynced.exchange(false)) {
+        schedRebuild(rtc.getEpoch());
+      }
+      if (prevSec != timeinfo.tm_sec) {
+        prevSec = timeinfo.tm_sec;
+        PROF_VALUE(PROF_SECOND, rtc.getMicros()); // us past the second edge
+        schedTick(rtc.getEpoch());
       }
     }
+
+    if (!pending) {
+      frame = displayFrame();
+    }
+    if (modeUpdate(currentMillis, timeinfo, frame) || pending) {
+      pending = !displayPost(frame);
+    }
+
+    uint32_t workUs = esp_timer_get_time() - wakeUs;
+    tickLateMax = max(tickLateMax, lateUs);
+    tickWorkMax = max(tickWorkMax, workUs);
+    tickWorkSum += workUs;
+    tickCount++;
+    taskBusy(modeSlot, workUs);
   }
 }
 
-void depoison() {
-  //blink fast for a bit
-  while (digitalRead(btn) == HIGH) { //wait for release
-    loadPinRegs(true);
-    delay(20);
-    loadPinRegs();
-    delay(20);
+//Resync connect result, from the wifi event or esp_timer task
+void onConnect(uint8_t status, uint8_t reason) {
+  connectReason = reason;
+  xTaskNotify(netTask, status == WL_CONNECTED ? NET_ONLINE : NET_OFFLINE, eSetBits);
+}
+
+//Starts the connect to the next ranked stored network, false when none is left
+bool connectNextStored() {
+  while (fallbackNext < fallbackCount) {
+    const wm_cred_t &cred = fallbackTries[fallbackNext++];
+    Serial.printf("resync: trying %s\n", cred.ssid);
+    //saved only if it connects
+    if (wifiManager.connectAsync(onConnect, WM_CREDS_TRY_MS, cred.ssid, cred.pass, false)) {
+      return true;
+    }
   }
-  bool end_loop = false;
-  int digit = 0; //digit to depoison
-  setAllPins(digit);
-  while (not end_loop) {
-    if (digitalRead(btn) == HIGH) {
-      //Exit routine -----------------------------------------------------------------
-      prevMillis = millis();
-      currentMillis = prevMillis;
-      while (digitalRead(btn) == HIGH) { //wait for release or hold for exit
-        currentMillis = millis();
-        if (currentMillis - prevMillis >= 3000) {
-          //blink fast for a bit
-          while (digitalRead(btn) == HIGH) { //wait for release
-            loadPinRegs(true);
-            delay(20);
-            loadPinRegs();
-            delay(20);
-          }
-          end_loop = true;
+  return false;
+}
+
+//WiFi and event stream, lowest priority, connects and scans only notify it so the stream keeps going
+//the web portal runs in its own task, this one sleeps until asked or an event client needs a keepalive
+void netLoop(void *) {
+  while (true) {
+    uint32_t req = 0;
+    xTaskNotifyWait(0, ULONG_MAX, &req, sseClients() ? pdMS_TO_TICKS(1000) : portMAX_DELAY);
+    int64_t start = esp_timer_get_time();
+    if (req & NET_RESYNC) {
+      //connect without blocking, the result comes back as a notification
+      powerActive(PWR_CLIENT_NET, true);
+      //a connect still in flight notifies when it ends, only nothing to connect to is offline now
+      if (!wifiManager.connectPending()) {
+        fallback = false;
+        if (!wifiManager.connectAsync(onConnect, 15000)) {
+          req |= NET_OFFLINE;
         }
       }
-      //Exit routine ----------------------------------------------------------------- 
-      digit++;
-      if (digit > 9) {
-        digit = 0;
+    }
+    if (req & NET_SCANNED) {
+      //quickest expected connect first, the saved network already failed
+      fallbackCount = wifiManager.rankStored(fallbackTries, wifiManager.getWiFiSSID());
+      fallbackNext = 0;
+      req |= NET_OFFLINE; // on to the first of them
+    }
+    else if (req & NET_OFFLINE) {
+      Serial.printf("resync: connect failed, reason %u\n", connectReason);
+    }
+    if (req & NET_OFFLINE) {
+      if (!fallback) {
+        //saved AP is gone, scan for the other known networks instead of the portal, nothing here blocks
+        fallback = true;
+        fallbackCount = 0;
+        fallbackNext = 0;
+        if (wifiManager.scanAsync([]() { xTaskNotify(netTask, NET_SCANNED, eSetBits); })) {
+          req &= ~NET_OFFLINE;
+        }
+      }
+      else if (connectNextStored()) {
+        req &= ~NET_OFFLINE; // its result comes back as a notification
       }
-      setAllPins(digit);
-      
     }
+    if (req & NET_ONLINE) {
+      struct tm synced;
+      getLocalTime(&synced); // waits for sntp, rtc reads the system time so nothing to copy
+      resynced = true;
+    }
+    if (req & (NET_ONLINE | NET_OFFLINE)) {
+      #ifndef NIXIE_WEB_ALWAYS
+      wifiManager.disconnect();
+      #endif
+      powerActive(PWR_CLIENT_NET, false);
+    }
+    {
+      PROF_SCOPE(PROF_HTTP);
+      ssePump();
+    }
+    taskBusy(netSlot, esp_timer_get_time() - start);
   }
 }
 
 void setup() {
-  Serial.begin(115200);
+  Serial.begin(460800); // matches monitor_speed
+  powerBegin();
+  settingsBegin();
+  apiBegin(wifiManager);
+  settingsPortal(wifiManager);
+  wifiManager.startPortalTask(TASK_PRIO_NET);
+  //upload percentage on the tubes, the flash writer task reports it
+  wifiManager.setPreOtaUpdateCallback([]() { modeShowProgress(0); });
+  wifiManager.setOtaProgressCallback([](uint32_t done, uint32_t total) {
+    modeShowProgress(total ? min<uint32_t>(done * 100ULL / total, 99) : 0);
+  });
+  wifiManager.setOtaFailCallback([]() { modeShowProgress(-1); }); // back to the clock now, not after the stall timeout
   wifiManager.autoConnect("AutoConnectAP");
-  initTime(timezone);
+  initTime();
   rtc.setTimeStruct(timeinfo);
-  //Shift Register
-  pinMode(serialDataPin, OUTPUT);
-  pinMode(clockPin, OUTPUT);
-  pinMode(latchPin, OUTPUT);
-  //Interrupt (ZeroCross detection)
-  pinMode(interruptPin, INPUT);
-  attachInterrupt(interruptPin, ISR, CHANGE);
+  displayBegin(settings().zcPin);
+  displaySetBrightness(settings().brightness);
+  //Button gestures
+  buttonBegin(settings().buttonPin);
 
   wifiManager.setConfigPortalTimeout(5);
+  #ifdef NIXIE_WEB_ALWAYS
+  //stay connected and keep the portal up for the JSON API
+  wifiManager.startWebPortal();
+  #else
   wifiManager.setWiFiAutoReconnect(false);
   wifiManager.disconnect();
+  #endif
+  schedBegin(onSchedule, rtc.getEpoch());
+  schedSetHours(SCHED_LIGHTSHOW, settings().showHours); // the settings own the daily lightshows
+
+  xTaskCreate(modeLoop, "modes", 4096, nullptr, TASK_PRIO_MODES, &modeTask);
+  modeSlot = taskStatsAdd("modes", modeTask);
+  xTaskCreate(netLoop, "net", 8192, nullptr, TASK_PRIO_NET, &netTask);
+  netSlot = taskStatsAdd("net", netTask);
+  sseBegin(netTask, NET_SSE);
+  if (wifiManager.getPortalTask()) {
+    taskStatsAdd("portal", wifiManager.getPortalTask()); // stack only, it doesn't report busy time
+  }
+  taskStatsAdd("loop", xTaskGetCurrentTaskHandle());
 }
 
 void loop() {
-  //get time from rtc every 50ms
-  currentMillis = millis();
-  if ((currentMillis - prevMillis >= 50)) {
-    prevMillis = currentMillis;
-    timeinfo = rtc.getTimeStruct();
-  }
-
-  if (digitalRead(btn) == HIGH){
-    //SHOW DATE///////////////////////////////////////////////////////////////////////////////////////////////
-    show_date();
-    prevMillis = millis();
-    currentMillis = prevMillis;
-
-    //DEPOISONING/////////////////////////////////////////////////////////////////////////////////////////////
-    while (digitalRead(btn) == HIGH) { //enter depoisoning if button helo for 3 sec
-      currentMillis = millis();
-      if (currentMillis - prevMillis >= 3000) {
-        depoison();
-      }
-    }
-    prevMillis = millis();
-    currentMillis = prevMillis;
-    //STOPWATCH///////////////////////////////////////////////////////////////////////////////////////////////
-    //if button not held, wait for a double press
-    while (currentMillis - prevMillis <= 200) { 
-      if (digitalRead(btn) == HIGH) {
-        //wait for btn depress
-        while(digitalRead(btn) == HIGH) {} 
-        stopwatch();
-      }
-      currentMillis = millis();
+  //everything runs in the tasks, loop only reports
+  printTickStats();
+  //'p' on the serial monitor dumps and resets the profile
+  while (Serial.available()) {
+    if (Serial.read() == 'p') {
+      PROF_DUMP(Serial);
     }
-    //LIGHTSHOW///////////////////////////////////////////////////////////////////////////////////////////////
-    //if button held when exiting, do the lightshow
-    delay(2000);
-    if (digitalRead(btn) == HIGH) {
-      lightshow();
-    }
-
-  }
-  //if a second turn over, update display register values
-  else if ((prevSec != timeinfo.tm_sec)) {
-    prevSec = timeinfo.tm_sec;
-    //if it's midnight, get atomic time
-    if ((timeinfo.tm_hour == 1)&&(timeinfo.tm_min == 0)&&(timeinfo.tm_sec == 0)) {
-      wifiManager.autoConnect("AutoConnectAP");
-      getLocalTime(&timeinfo);
-      wifiManager.disconnect();
-    }
-    //Do a lightshow at midnight and noon
-    else if ((timeinfo.tm_hour == 0)&&(timeinfo.tm_min == 0)&&(timeinfo.tm_sec == 0)) {
-      lightshow();
-    }
-    else if ((timeinfo.tm_hour == 12)&&(timeinfo.tm_min == 0)&&(timeinfo.tm_sec == 0)) {
-      lightshow();
-    }
-    //Get tens and units of time
-    nixie[0] = timeinfo.tm_sec%10;
-    nixie[1] = timeinfo.tm_sec/10;
-    nixie[2] = timeinfo.tm_min%10;
-    nixie[3] = timeinfo.tm_min/10;
-    nixie[4] = timeinfo.tm_hour%10;
-    nixie[5] = timeinfo.tm_hour/10;
-
-    loadPinRegs();
   }
+  delay(100);
 }
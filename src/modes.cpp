@@ -0,0 +1,540 @@
+#include "modes.h"
+#include "scheduler.h"
+#include "profiler.h"
+#include <stopwatch.h>
+#include <lightshow.h>
+#include <esp_timer.h>
+#include <atomic>
+
+static mode_id_t current = MODE_CLOCK;
+static bool entered = false;   // enter() of current already ran
+static struct tm lastNow;      // time of the last update, for enter() from events
+static std::atomic<int> progress(-1);        // set by the uploading task
+static std::atomic<bool> progressNew(false);
+static uint32_t progressMillis;              // last progress report
+
+static const clock_mode_t *modeTable();
+
+void modeSwitch(mode_id_t id) {
+  current = id;
+  entered = false;
+}
+
+mode_id_t modeCurrent() {
+  return current;
+}
+
+const char *modeName(mode_id_t id) {
+  return id < MODE_COUNT ? modeTable()[id].name : "?";
+}
+
+bool modeIdle() {
+  return entered && current == MODE_CLOCK;
+}
+
+static void enterPending(uint32_t ms) {
+  //an enter() may switch again, settle before handing over
+  while (!entered) {
+    entered = true;
+    modeTable()[current].enter(ms, lastNow);
+  }
+}
+
+void modeEvent(const button_event_t &ev, uint32_t ms) {
+  enterPending(ms);
+  modeTable()[current].event(ev, ms);
+}
+
+bool modeUpdate(uint32_t ms, const struct tm &now, frame_t &frame) {
+  lastNow = now;
+  //mode changes stay on this task, other tasks only leave a request
+  if (progressNew.exchange(false)) {
+    progressMillis = ms;
+    if (progress >= 0 && current != MODE_OTA) {
+      modeSwitch(MODE_OTA);
+    }
+  }
+  enterPending(ms);
+  return modeTable()[current].update(ms, now, frame);
+}
+
+//CLOCK///////////////////////////////////////////////////////////////////////////////////////////////////
+static int clockSec = -1;
+
+static void clockEnter(uint32_t ms, const struct tm &now) {
+  clockSec = -1; // refresh on the first update
+}
+
+static bool clockUpdate(uint32_t ms, const struct tm &now, frame_t &frame) {
+  //if a second turn over, update display register values
+  if (clockSec == now.tm_sec) {
+    return false;
+  }
+  clockSec = now.tm_sec;
+  PROF_SCOPE(PROF_ENCODE);
+  //Get tens and units of time
+  uint8_t digit[NUM_TUBES];
+  digitsClock(digit, now);
+  frameDigits(frame, digit);
+  return true;
+}
+
+static void clockEvent(const button_event_t &ev, uint32_t ms) {
+  if (ev.gesture == BTN_DOWN) {
+    modeSwitch(MODE_DATE);
+  }
+}
+
+//DATE////////////////////////////////////////////////////////////////////////////////////////////////////
+static bool dateShown = false;
+static uint32_t dateMillis = 0; // date timeout start, 0 while the first press is held
+
+static void dateEnter(uint32_t ms, const struct tm &now) {
+  dateShown = false;
+  dateMillis = 0;
+}
+
+static bool dateUpdate(uint32_t ms, const struct tm &now, frame_t &frame) {
+  if (dateMillis && ms - dateMillis >= 2000) {
+    //LIGHTSHOW, if button held when the date times out
+    modeSwitch(buttonPressed() ? MODE_LIGHTSHOW : MODE_CLOCK);
+    return false;
+  }
+  if (dateShown) {
+    return false;
+  }
+  dateShown = true;
+  uint8_t digit[NUM_TUBES];
+  digitsDate(digit, now);
+  frameDigits(frame, digit);
+  return true;
+}
+
+static void dateEvent(const button_event_t &ev, uint32_t ms) {
+  switch (ev.gesture) {
+    //keep the date for 2 sec after a single click
+    case BTN_CLICK:
+      dateMillis = ms ? ms : 1;
+      break;
+    case BTN_DOUBLE:
+      modeSwitch(MODE_STOPWATCH);
+      break;
+    case BTN_HOLD: //button held for 3 sec
+      modeSwitch(MODE_DEPOISON);
+      break;
+    default:
+      break;
+  }
+}
+
+//STOPWATCH///////////////////////////////////////////////////////////////////////////////////////////////
+/*
+zero:    press starts, double click switches to the countdown, hold exits
+running: click takes a lap, double click stops, both at the time of the first press
+stopped: click recalls the next lap, double click toggles lap/split view, hold clears
+Recall flashes the lap number for 500ms, on the right pair for laps, on the left pair for splits.
+*/
+#define SW_FLASH_MS 500
+static int32_t swShown;      // hundredths on the tubes, -1 forces a refresh
+static int64_t swPressUs;    // first press of the gesture in progress, 0 if none, -1 for the start press
+static int swRecall;         // recalled lap, -1 shows the stopwatch
+static bool swSplitView;
+static uint32_t swFlashMillis;
+static bool swDirty;
+
+//Shows elapsed time as mm:ss:hh
+static void showElapsed(frame_t &frame, int64_t elapsedUs) {
+  uint8_t digit[NUM_TUBES];
+  digitsElapsed(digit, elapsedUs);
+  frameDigits(frame, digit);
+}
+
+static bool swZero() {
+  return !swRunning() && swElapsed(0) == 0; // stopped time doesn't depend on now
+}
+
+static void stopwatchEnter(uint32_t ms, const struct tm &now) {
+  swReset();
+  swShown = -1;
+  swPressUs = 0;
+  swRecall = -1;
+  swSplitView = false;
+}
+
+static bool stopwatchUpdate(uint32_t ms, const struct tm &now, frame_t &frame) {
+  if (swRecall >= 0) {
+    sw_lap_t lap;
+    swGetLap(swRecall, lap);
+    bool flash = ms - swFlashMillis < SW_FLASH_MS;
+    if (!swDirty && !(swFlashMillis && !flash)) {
+      return false;
+    }
+    swDirty = false;
+    if (flash) {
+      uint8_t digit[NUM_TUBES];
+      memset(digit, DIGIT_BLANK, sizeof(digit));
+      framePair(digit, swSplitView ? 2 : 0, lap.number % 100);
+      frameDigits(frame, digit);
+    }
+    else {
+      swFlashMillis = 0;
+      showElapsed(frame, swSplitView ? lap.splitUs : lap.lapUs);
+    }
+    return true;
+  }
+  //only commit when the hundredths change
+  int64_t elapsed = swElapsed(esp_timer_get_time());
+  int32_t hundredths = elapsed / 10000;
+  if (hundredths == swShown) {
+    return false;
+  }
+  swShown = hundredths;
+  showElapsed(frame, elapsed);
+  return true;
+}
+
+static void swShowLap(int i, uint32_t ms) {
+  swRecall = i;
+  swFlashMillis = ms ? ms : 1;
+  swDirty = true;
+  swShown = -1;
+}
+
+static void stopwatchEvent(const button_event_t &ev, uint32_t ms) {
+  //times use the debounced edge of the first press, not when the gesture was recognized
+  if (ev.gesture == BTN_DOWN) {
+    if (swZero()) {
+      swStart(ev.us);
+      swPressUs = -1; // its click or double click is not a lap
+    }
+    else if (!swPressUs) {
+      swPressUs = ev.us;
+    }
+    return;
+  }
+  int64_t pressUs = swPressUs;
+  if (ev.gesture == BTN_CLICK || ev.gesture == BTN_DOUBLE || ev.gesture == BTN_HOLD) {
+    swPressUs = 0;
+  }
+  if (pressUs < 0) {
+    //double click at zero, the first press started it
+    if (ev.gesture == BTN_DOUBLE) {
+      modeSwitch(MODE_COUNTDOWN);
+    }
+    return;
+  }
+  if (swRunning()) {
+    if (ev.gesture == BTN_CLICK) {
+      swLap(pressUs);
+    }
+    else if (ev.gesture == BTN_DOUBLE) {
+      swLap(pressUs); // the last lap ends at the stop
+      swStop(pressUs);
+    }
+    return;
+  }
+  if (swZero()) {
+    //zero, hold jumps out of stopwatch mode
+    if (ev.gesture == BTN_HOLD) {
+      modeSwitch(MODE_CLOCK);
+    }
+    return;
+  }
+  switch (ev.gesture) {
+    case BTN_CLICK: //next lap, back to the stopwatch after the last one
+      if (swRecall + 1 < swLapsKept()) {
+        swShowLap(swRecall + 1, ms);
+      }
+      else {
+        swRecall = -1;
+        swShown = -1;
+      }
+      break;
+    case BTN_DOUBLE:
+      swSplitView = !swSplitView;
+      if (swRecall >= 0) {
+        swShowLap(swRecall, ms);
+      }
+      break;
+    case BTN_HOLD:
+      swReset();
+      swRecall = -1;
+      swShown = -1;
+      break;
+    default:
+      break;
+  }
+}
+
+//DEPOISON////////////////////////////////////////////////////////////////////////////////////////////////
+static enum { DP_BLINK_IN, DP_CYCLE, DP_BLINK_OUT } dpState;
+static frame_t dpBlinkFrame;    // frame blinked on entry and exit
+static uint32_t dpBlinkMillis;
+static bool dpBlank;
+static int dpDigit;             // digit to depoison
+static bool dpDirty;
+
+static void depoisonEnter(uint32_t ms, const struct tm &now) {
+  dpState = DP_BLINK_IN;
+  dpBlinkFrame = displayFrame();
+  dpBlinkMillis = ms;
+  dpBlank = false;
+  dpDigit = 0;
+}
+
+static bool depoisonUpdate(uint32_t ms, const struct tm &now, frame_t &frame) {
+  if (dpState == DP_CYCLE) {
+    if (!dpDirty) {
+      return false;
+    }
+    dpDirty = false;
+    frameAll(frame, dpDigit);
+    return true;
+  }
+  //blink fast until released
+  if (ms - dpBlinkMillis < 20) {
+    return false;
+  }
+  dpBlinkMillis = ms;
+  dpBlank = !dpBlank;
+  if (dpBlank) {
+    frameClear(frame);
+  }
+  else {
+    frame = dpBlinkFrame;
+  }
+  return true;
+}
+
+static void depoisonEvent(const button_event_t &ev, uint32_t ms) {
+  switch (dpState) {
+    case DP_BLINK_IN:
+      if (ev.gesture == BTN_UP) {
+        dpState = DP_CYCLE;
+        dpDirty = true;
+      }
+      break;
+    case DP_CYCLE:
+      if (ev.gesture == BTN_UP) {
+        dpDigit = (dpDigit + 1) % 10;
+        dpDirty = true;
+      }
+      //Exit routine, hold for 3 sec then blink until released
+      else if (ev.gesture == BTN_HOLD) {
+        dpState = DP_BLINK_OUT;
+      }
+      break;
+    case DP_BLINK_OUT:
+      if (ev.gesture == BTN_UP) {
+        modeSwitch(MODE_CLOCK);
+      }
+      break;
+  }
+}
+
+//LIGHTSHOW///////////////////////////////////////////////////////////////////////////////////////////////
+static std::vector<show_step_t> show;
+static size_t showStep;
+static uint32_t showMillis;
+static bool showFirst; // first step not committed yet
+
+static void lightshowEnter(uint32_t ms, const struct tm &now) {
+  //precomputed, so update() only has to pick the step for the current time
+  showBuild(show, displayFrame(), now);
+  showStep = 0;
+  showMillis = ms;
+  showFirst = true;
+}
+
+static bool lightshowUpdate(uint32_t ms, const struct tm &now, frame_t &frame) {
+  size_t step = showAdvance(show, showStep, showMillis, ms);
+  if (step >= show.size()) {
+    std::vector<show_step_t>().swap(show); // free the show
+    buttonFlush(); // presses during the show are ignored
+    modeSwitch(MODE_CLOCK);
+    return false;
+  }
+  if (step == showStep && !showFirst) {
+    return false;
+  }
+  showStep = step;
+  showFirst = false;
+  frameRaw(frame, show[step].a, show[step].b);
+  return true;
+}
+
+static void lightshowEvent(const button_event_t &ev, uint32_t ms) {
+}
+
+//COUNTDOWN///////////////////////////////////////////////////////////////////////////////////////////////
+/*
+setting: click adds a minute, double click ten, starts 3 sec after the last press, hold exits
+running: shows the time left, click goes back to the clock, hold cancels
+The countdown itself is a scheduler rule, so it keeps running in other modes and across reboots.
+*/
+#define CD_START_MS 3000
+static int cdSlot;             // running countdown, -1 while setting
+static uint16_t cdMinutes;     // set duration
+static uint32_t cdPressMillis; // last setting press
+static int32_t cdShown;        // seconds on the tubes, -1 forces a refresh
+
+//Shows a duration as hh:mm:ss
+static void showDuration(frame_t &frame, uint32_t seconds) {
+  uint8_t digit[NUM_TUBES];
+  digitsDuration(digit, seconds);
+  frameDigits(frame, digit);
+}
+
+static void countdownEnter(uint32_t ms, const struct tm &now) {
+  cdSlot = schedNextCountdown();
+  cdMinutes = 0;
+  cdPressMillis = 0;
+  cdShown = -1;
+}
+
+static bool countdownUpdate(uint32_t ms, const struct tm &now, frame_t &frame) {
+  int32_t seconds;
+  if (cdSlot >= 0) {
+    sched_rule_t rule;
+    time_t due;
+    if (!schedGet(cdSlot, rule, due) || rule.action != SCHED_COUNTDOWN || rule.kind != SCHED_ONCE) {
+      cdSlot = -1; // fired or removed, maybe reused by another rule since
+      return false;
+    }
+    time_t left = due - time(nullptr);
+    seconds = left > 0 ? left : 0;
+  }
+  else {
+    if (cdMinutes && ms - cdPressMillis >= CD_START_MS) {
+      sched_rule_t rule = {SCHED_ONCE, SCHED_COUNTDOWN, 0, 0, 0, 0, (uint32_t)(time(nullptr) + cdMinutes * 60)};
+      cdSlot = schedAdd(rule);
+      cdMinutes = 0;
+      return false;
+    }
+    seconds = cdMinutes * 60;
+  }
+  if (seconds == cdShown) {
+    return false;
+  }
+  cdShown = seconds;
+  showDuration(frame, seconds);
+  return true;
+}
+
+static void countdownEvent(const button_event_t &ev, uint32_t ms) {
+  if (cdSlot >= 0) {
+    if (ev.gesture == BTN_CLICK) {
+      modeSwitch(MODE_CLOCK);
+    }
+    else if (ev.gesture == BTN_HOLD) {
+      schedRemove(cdSlot);
+      cdSlot = -1;
+      cdShown = -1;
+    }
+    return;
+  }
+  switch (ev.gesture) {
+    case BTN_CLICK:
+      cdMinutes = (cdMinutes + 1) % (100 * 60);
+      cdPressMillis = ms;
+      break;
+    case BTN_DOUBLE:
+      cdMinutes = (cdMinutes + 10) % (100 * 60);
+      cdPressMillis = ms;
+      break;
+    case BTN_HOLD:
+      modeSwitch(MODE_CLOCK);
+      break;
+    default:
+      break;
+  }
+}
+
+//ALARM///////////////////////////////////////////////////////////////////////////////////////////////////
+//Blinks the time until a press or for a minute
+#define ALARM_BLINK_MS 250
+#define ALARM_MS       60000
+static uint32_t alarmMillis, alarmBlinkMillis;
+static bool alarmBlank;
+
+static void alarmEnter(uint32_t ms, const struct tm &now) {
+  alarmMillis = ms;
+  alarmBlinkMillis = ms - ALARM_BLINK_MS;
+  alarmBlank = true;
+}
+
+static bool alarmUpdate(uint32_t ms, const struct tm &now, frame_t &frame) {
+  if (ms - alarmMillis >= ALARM_MS) {
+    modeSwitch(MODE_CLOCK);
+    return false;
+  }
+  if (ms - alarmBlinkMillis < ALARM_BLINK_MS) {
+    return false;
+  }
+  alarmBlinkMillis = ms;
+  alarmBlank = !alarmBlank;
+  if (alarmBlank) {
+    frameClear(frame);
+  }
+  else {
+    clockSec = -1;
+    clockUpdate(ms, now, frame);
+  }
+  return true;
+}
+
+static void alarmEvent(const button_event_t &ev, uint32_t ms) {
+  if (ev.gesture == BTN_DOWN) {
+    buttonFlush(); // the rest of this press is not for the clock
+    modeSwitch(MODE_CLOCK);
+  }
+}
+
+//OTA/////////////////////////////////////////////////////////////////////////////////////////////////////
+//Upload percentage on the right tubes, back to the clock when it ends or stalls
+#define OTA_STALL_MS 10000
+static int otaShown;
+
+void modeShowProgress(int percent) {
+  progress = percent;
+  progressNew = true;
+}
+
+static void otaEnter(uint32_t ms, const struct tm &now) {
+  otaShown = -1;
+}
+
+static bool otaUpdate(uint32_t ms, const struct tm &now, frame_t &frame) {
+  int percent = progress;
+  if (percent < 0 || ms - progressMillis >= OTA_STALL_MS) {
+    progress = -1;
+    modeSwitch(MODE_CLOCK);
+    return false;
+  }
+  if (percent == otaShown) {
+    return false;
+  }
+  otaShown = percent;
+  uint8_t digit[NUM_TUBES];
+  digitsPercent(digit, percent);
+  frameDigits(frame, digit);
+  return true;
+}
+
+static void otaEvent(const button_event_t &ev, uint32_t ms) {
+}
+
+static const clock_mode_t modes[MODE_COUNT] = {
+  {"clock",     clockEnter,     clockUpdate,     clockEvent},
+  {"date",      dateEnter,      dateUpdate,      dateEvent},
+  {"stopwatch", stopwatchEnter, stopwatchUpdate, stopwatchEvent},
+  {"depoison",  depoisonEnter,  depoisonUpdate,  depoisonEvent},
+  {"lightshow", lightshowEnter, lightshowUpdate, lightshowEvent},
+  {"countdown", countdownEnter, countdownUpdate, countdownEvent},
+  {"alarm",     alarmEnter,     alarmUpdate,     alarmEvent},
+  {"ota",       otaEnter,       otaUpdate,       otaEvent},
+};
+
+static const clock_mode_t *modeTable() {
+  return modes;
+}
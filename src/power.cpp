@@ -0,0 +1,115 @@
+#include "power.h"
+#include <esp_pm.h>
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+#include <hal/gpio_ll.h>
+#include <esp_timer.h>
+
+static const char *stateNames[PWR_COUNT] = {"idle", "tick", "active"};
+
+static bool lightSleep = false;
+static bool pmOk = false;
+static esp_pm_lock_handle_t cpuLock;
+static portMUX_TYPE pwrMux = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t activeClients = 0;
+static power_state_t modesState = PWR_TICK;
+static power_state_t state = PWR_TICK;
+static int64_t stateUs = 0;            // when state was entered
+static int64_t residencyUs[PWR_COUNT];
+static int64_t reportUs = 0;
+
+//Books the time of the old state, call with pwrMux held
+static void enterState(power_state_t next) {
+  int64_t now = esp_timer_get_time();
+  residencyUs[state] += now - stateUs;
+  stateUs = now;
+  state = next;
+}
+
+static void update() {
+  enterState(activeClients ? PWR_ACTIVE : modesState);
+}
+
+void powerBegin() {
+  esp_pm_config_esp32c3_t cfg = {PWR_MAX_MHZ, PWR_MIN_MHZ, true};
+  esp_err_t err = esp_pm_configure(&cfg);
+  if (err != ESP_OK) {
+    //no tickless idle in this core build, scale the clock only
+    Serial.printf("pm: light sleep unavailable (%s), DFS only\n", esp_err_to_name(err));
+    cfg.light_sleep_enable = false;
+    err = esp_pm_configure(&cfg);
+  }
+  pmOk = err == ESP_OK;
+  lightSleep = pmOk && cfg.light_sleep_enable;
+  if (pmOk) {
+    esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "nixie", &cpuLock);
+  }
+  else {
+    Serial.printf("pm: not available (%s)\n", esp_err_to_name(err));
+  }
+  esp_sleep_enable_gpio_wakeup();
+  stateUs = reportUs = esp_timer_get_time();
+}
+
+bool powerLightSleep() {
+  return lightSleep;
+}
+
+void powerModes(power_state_t s) {
+  portENTER_CRITICAL(&pwrMux);
+  if (modesState != s) {
+    modesState = s;
+    update();
+  }
+  portEXIT_CRITICAL(&pwrMux);
+}
+
+void powerActive(uint8_t client, bool on) {
+  portENTER_CRITICAL(&pwrMux);
+  uint32_t was = activeClients;
+  activeClients = on ? was | (1UL << client) : was & ~(1UL << client);
+  if (!was != !activeClients) {
+    update();
+  }
+  portEXIT_CRITICAL(&pwrMux);
+  //the lock only changes on the first and last client
+  if (pmOk && !was && activeClients) {
+    esp_pm_lock_acquire(cpuLock);
+  }
+  else if (pmOk && was && !activeClients) {
+    esp_pm_lock_release(cpuLock);
+  }
+}
+
+void powerAttachWake(uint8_t pin, void (*isr)()) {
+  pinMode(pin, INPUT);
+  bool high = digitalRead(pin) == HIGH;
+  attachInterrupt(pin, isr, high ? ONLOW : ONHIGH);
+  gpio_wakeup_enable((gpio_num_t)pin, high ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+}
+
+bool IRAM_ATTR powerRearm(uint8_t pin) {
+  //a level interrupt only fires again once the pin went the other way, that gives both edges
+  bool high = gpio_ll_get_level(&GPIO, (gpio_num_t)pin);
+  gpio_ll_set_intr_type(&GPIO, (gpio_num_t)pin, high ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+  return high;
+}
+
+void powerStats(Print &out) {
+  int64_t res[PWR_COUNT];
+  portENTER_CRITICAL(&pwrMux);
+  enterState(state);
+  memcpy(res, residencyUs, sizeof(res));
+  memset(residencyUs, 0, sizeof(residencyUs));
+  portEXIT_CRITICAL(&pwrMux);
+  int64_t now = esp_timer_get_time();
+  int64_t elapsed = now - reportUs;
+  reportUs = now;
+  out.printf("power: %s,", !pmOk ? "no pm" : lightSleep ? "dfs+light sleep" : "dfs");
+  for (int i = 0; i < PWR_COUNT; i++) {
+    out.printf(" %s %lu.%lu%%", stateNames[i], (unsigned long)(res[i] * 100 / elapsed),
+               (unsigned long)(res[i] * 1000 / elapsed % 10));
+  }
+  out.print("\n");
+}
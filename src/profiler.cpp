@@ -0,0 +1,65 @@
+#include "profiler.h"
+
+#ifdef NIXIE_PROFILE
+
+struct prof_hist_t {
+  uint32_t count;
+  uint32_t max;
+  uint64_t sum;
+  uint32_t bucket[PROF_BUCKETS];
+};
+
+static const char *spanNames[PROF_COUNT] = {"isr", "encode", "timeread", "http", "tick", "second"};
+static prof_hist_t hist[PROF_COUNT];
+static portMUX_TYPE profMux = portMUX_INITIALIZER_UNLOCKED;
+
+void IRAM_ATTR profAdd(prof_span_t span, uint32_t value) {
+  int b = value ? 32 - __builtin_clz(value) : 0;
+  if (b >= PROF_BUCKETS) {
+    b = PROF_BUCKETS - 1;
+  }
+  portENTER_CRITICAL_SAFE(&profMux);
+  prof_hist_t &h = hist[span];
+  h.count++;
+  h.sum += value;
+  if (value > h.max) {
+    h.max = value;
+  }
+  h.bucket[b]++;
+  portEXIT_CRITICAL_SAFE(&profMux);
+}
+
+void profDump(Print &out, bool reset) {
+  //copy under the lock, print outside of it
+  prof_hist_t snap[PROF_COUNT];
+  portENTER_CRITICAL(&profMux);
+  memcpy(snap, hist, sizeof(hist));
+  if (reset) {
+    memset(hist, 0, sizeof(hist));
+  }
+  portEXIT_CRITICAL(&profMux);
+
+  uint32_t mhz = getCpuFrequencyMhz();
+  out.printf("profile @%luMHz\n", (unsigned long)mhz);
+  for (int i = 0; i < PROF_COUNT; i++) {
+    prof_hist_t &h = snap[i];
+    if (!h.count) {
+      continue;
+    }
+    const char *unit = i == PROF_SECOND ? "us" : "cyc";
+    out.printf("%-8s n %lu avg %lu%s max %lu%s", spanNames[i], (unsigned long)h.count,
+               (unsigned long)(h.sum / h.count), unit, (unsigned long)h.max, unit);
+    if (i != PROF_SECOND) {
+      out.printf(" (max %luus)", (unsigned long)(h.max / mhz));
+    }
+    out.print("\n ");
+    for (int b = 0; b < PROF_BUCKETS; b++) {
+      if (h.bucket[b]) {
+        out.printf(" <%lu:%lu", (unsigned long)(1UL << b), (unsigned long)h.bucket[b]);
+      }
+    }
+    out.print("\n");
+  }
+}
+
+#endif
@@ -0,0 +1,250 @@
+#include "scheduler.h"
+#include <Preferences.h>
+#include <freertos/semphr.h>
+
+static sched_rule_t rules[SCHED_MAX];
+static bool used[SCHED_MAX];
+static sched_wheel_t wheel;      // slot i of rules is timer i
+static bool started = false;
+
+static sched_fire_t onFire = nullptr;
+static SemaphoreHandle_t schedLock = nullptr;
+
+static const sched_rule_t defaults[] = {
+  //Do a lightshow at midnight and noon
+  {SCHED_DAILY, SCHED_LIGHTSHOW, SCHED_EVERYDAY, 0, 0, 0, 0},
+  {SCHED_DAILY, SCHED_LIGHTSHOW, SCHED_EVERYDAY, 12, 0, 0, 0},
+  //get atomic time at 1 am
+  {SCHED_DAILY, SCHED_RESYNC, SCHED_EVERYDAY, 1, 0, 0, 0},
+};
+
+static void save() {
+  sched_rule_t store[SCHED_MAX];
+  int n = 0;
+  for (int i = 0; i < SCHED_MAX; i++) {
+    if (used[i]) {
+      store[n++] = rules[i];
+    }
+  }
+  Preferences prefs;
+  prefs.begin("sched", false);
+  prefs.putUChar("ver", SCHED_VERSION);
+  prefs.putBytes("rules", store, n * sizeof(sched_rule_t));
+  prefs.end();
+}
+
+static void load() {
+  sched_rule_t store[SCHED_MAX];
+  int n = 0;
+  Preferences prefs;
+  prefs.begin("sched", true);
+  if (prefs.getUChar("ver", 0) == SCHED_VERSION) {
+    n = prefs.getBytes("rules", store, sizeof(store)) / sizeof(sched_rule_t);
+  }
+  else {
+    n = sizeof(defaults) / sizeof(defaults[0]);
+    memcpy(store, defaults, sizeof(defaults));
+  }
+  prefs.end();
+  for (int i = 0; i < SCHED_MAX; i++) {
+    used[i] = i < n;
+    if (used[i]) {
+      rules[i] = store[i];
+    }
+  }
+}
+
+//Due time of a rule seen from now, 0 drops a stale one shot
+static uint32_t dueFrom(const sched_rule_t &r, time_t now) {
+  if (r.kind == SCHED_DAILY) {
+    return schedNextDaily(r, now - 1);
+  }
+  if (r.at + SCHED_STALE < (uint32_t)now) {
+    return 0;
+  }
+  return r.at;
+}
+
+static void rebuild(time_t now) {
+  wheelReset(wheel, now);
+  bool dropped = false;
+  for (int i = 0; i < SCHED_MAX; i++) {
+    if (!used[i]) {
+      continue;
+    }
+    uint32_t due = dueFrom(rules[i], now);
+    if (!due) {
+      used[i] = false;
+      dropped = true;
+      continue;
+    }
+    wheelAdd(wheel, i, due);
+  }
+  if (dropped) {
+    save();
+  }
+}
+
+void schedBegin(sched_fire_t fire, time_t now) {
+  schedLock = xSemaphoreCreateMutex();
+  onFire = fire;
+  load();
+  rebuild(now);
+  started = true;
+}
+
+void schedRebuild(time_t now) {
+  if (!started) {
+    return;
+  }
+  xSemaphoreTake(schedLock, portMAX_DELAY);
+  rebuild(now);
+  xSemaphoreGive(schedLock);
+}
+
+void schedTick(time_t now) {
+  if (!started) {
+    return;
+  }
+  sched_rule_t fired[SCHED_MAX];
+  int nfired = 0;
+  bool changed = false;
+  xSemaphoreTake(schedLock, portMAX_DELAY);
+  //clock went back, or jumped further than worth stepping through
+  if ((int64_t)now + 1 < wheel.cur || (int64_t)now - wheel.cur > SCHED_CATCHUP) {
+    rebuild(now);
+  }
+  while (wheel.cur <= (uint32_t)now) {
+    uint32_t t = wheel.cur;
+    for (int8_t i = wheelStep(wheel); i >= 0;) {
+      int8_t n = wheel.next[i];
+      if (nfired < SCHED_MAX) {
+        fired[nfired++] = rules[i];
+      }
+      if (rules[i].kind == SCHED_DAILY) {
+        wheelAdd(wheel, i, schedNextDaily(rules[i], t));
+      }
+      else {
+        used[i] = false;
+        changed = true;
+      }
+      i = n;
+    }
+  }
+  if (changed) {
+    save();
+  }
+  xSemaphoreGive(schedLock);
+  //callbacks run unlocked, they may add or remove rules
+  for (int i = 0; i < nfired; i++) {
+    onFire(fired[i]);
+  }
+}
+
+int schedAdd(const sched_rule_t &rule) {
+  xSemaphoreTake(schedLock, portMAX_DELAY);
+  int slot = -1;
+  for (int i = 0; i < SCHED_MAX; i++) {
+    if (!used[i]) {
+      slot = i;
+      break;
+    }
+  }
+  if (slot >= 0) {
+    rules[slot] = rule;
+    used[slot] = true;
+    wheelAdd(wheel, slot, rule.kind == SCHED_DAILY ? schedNextDaily(rule, wheel.cur - 1) : rule.at);
+    save();
+  }
+  xSemaphoreGive(schedLock);
+  return slot;
+}
+
+bool schedRemove(int slot) {
+  if (slot < 0 || slot >= SCHED_MAX) {
+    return false;
+  }
+  xSemaphoreTake(schedLock, portMAX_DELAY);
+  bool was = used[slot];
+  if (was) {
+    wheelRemove(wheel, slot);
+    used[slot] = false;
+    save();
+  }
+  xSemaphoreGive(schedLock);
+  return was;
+}
+
+bool schedGet(int slot, sched_rule_t &rule, time_t &when) {
+  if (slot < 0 || slot >= SCHED_MAX) {
+    return false;
+  }
+  xSemaphoreTake(schedLock, portMAX_DELAY);
+  bool ok = used[slot];
+  if (ok) {
+    rule = rules[slot];
+    when = wheel.due[slot];
+  }
+  xSemaphoreGive(schedLock);
+  return ok;
+}
+
+int schedNextCountdown() {
+  xSemaphoreTake(schedLock, portMAX_DELAY);
+  int best = -1;
+  for (int i = 0; i < SCHED_MAX; i++) {
+    if (used[i] && rules[i].action == SCHED_COUNTDOWN && (best < 0 || wheel.due[i] < wheel.due[best])) {
+      best = i;
+    }
+  }
+  xSemaphoreGive(schedLock);
+  return best;
+}
+
+int schedSetHours(uint8_t action, uint32_t hours) {
+  if (!started) {
+    return 0;
+  }
+  xSemaphoreTake(schedLock, portMAX_DELAY);
+  //nothing to write if the rules are already exactly these hours
+  uint32_t have = 0;
+  bool other = false;
+  for (int i = 0; i < SCHED_MAX; i++) {
+    if (used[i] && rules[i].kind == SCHED_DAILY && rules[i].action == action) {
+      const sched_rule_t &r = rules[i];
+      bool plain = r.days == SCHED_EVERYDAY && r.min == 0 && r.sec == 0 && !(have & (1UL << r.hour));
+      other |= !plain;
+      have |= 1UL << r.hour;
+    }
+  }
+  if (!other && have == hours) {
+    xSemaphoreGive(schedLock);
+    return 0;
+  }
+  for (int i = 0; i < SCHED_MAX; i++) {
+    if (used[i] && rules[i].kind == SCHED_DAILY && rules[i].action == action) {
+      wheelRemove(wheel, i);
+      used[i] = false;
+    }
+  }
+  int missing = 0;
+  int slot = 0;
+  for (int h = 0; h < 24; h++) {
+    if (!(hours & (1UL << h))) {
+      continue;
+    }
+    while (slot < SCHED_MAX && used[slot]) {
+      slot++;
+    }
+    if (slot == SCHED_MAX) {
+      missing++;
+      continue;
+    }
+    rules[slot] = {SCHED_DAILY, action, SCHED_EVERYDAY, (uint8_t)h, 0, 0, 0};
+    used[slot] = true;
+    wheelAdd(wheel, slot, schedNextDaily(rules[slot], wheel.cur - 1));
+  }
+  save();
+  xSemaphoreGive(schedLock);
+  return missing;
+}
@@ -0,0 +1,224 @@
+#include "settings.h"
+#include "display.h"
+#include "scheduler.h"
+#include <Preferences.h>
+#include <esp_rom_crc.h>
+
+//NVS record, the CRC covers the header fields after it and the settings
+struct settings_record_t {
+  uint32_t crc;
+  uint16_t version;
+  uint16_t size;
+  settings_t s;
+};
+
+static const settings_t defaults = {
+  "CET-1CEST,M3.5.0,M10.5.0/3", // Europe/Rome including daylight adjustment rules
+  "pool.ntp.org",
+  "time.nist.gov",
+  3600,
+  3600,
+  (1UL << 0) | (1UL << 12),     // lightshow at midnight and noon, like the scheduler defaults
+  DISPLAY_BRIGHT_MAX,
+  3,                            // capacitive button
+  10,                           // zero cross detector
+  0
+};
+
+//Live copy, sntp keeps pointers to the server names in it
+static settings_t cfg;
+
+static uint32_t recordCrc(const settings_record_t &rec) {
+  return esp_rom_crc32_le(0, (const uint8_t *)&rec.version, sizeof(rec) - sizeof(rec.crc));
+}
+
+static void save() {
+  settings_record_t rec;
+  memset(&rec, 0, sizeof(rec));
+  rec.version = SETTINGS_VERSION;
+  rec.size = sizeof(settings_t);
+  rec.s = cfg;
+  rec.crc = recordCrc(rec);
+  Preferences prefs;
+  prefs.begin("clock", false);
+  prefs.putBytes("cfg", &rec, sizeof(rec));
+  prefs.end();
+}
+
+void settingsBegin() {
+  settings_record_t rec;
+  Preferences prefs;
+  prefs.begin("clock", true);
+  size_t len = prefs.getBytes("cfg", &rec, sizeof(rec));
+  prefs.end();
+  if (len == sizeof(rec) && rec.version == SETTINGS_VERSION && rec.size == sizeof(settings_t) &&
+      rec.crc == recordCrc(rec)) {
+    cfg = rec.s;
+  }
+  else {
+    cfg = defaults;
+  }
+  //terminated whatever the flash held
+  cfg.tz[sizeof(cfg.tz) - 1] = '\0';
+  cfg.ntp1[sizeof(cfg.ntp1) - 1] = '\0';
+  cfg.ntp2[sizeof(cfg.ntp2) - 1] = '\0';
+}
+
+const settings_t &settings() {
+  return cfg;
+}
+
+//GPIOs a button or the zero cross input can't take: the shift register, SPI flash 12-17 and USB 18/19
+static const uint32_t reservedPins = (1UL << DISPLAY_DATA_PIN) | (1UL << DISPLAY_LATCH_PIN) |
+                                     (1UL << DISPLAY_CLOCK_PIN) | (0x3FUL << 12) | (3UL << 18);
+
+static bool pinFree(uint8_t pin) {
+  return pin <= SETTINGS_PIN_MAX && !(reservedPins & (1UL << pin));
+}
+
+static const char *validate(const settings_t &s) {
+  if (!memchr(s.tz, '\0', sizeof(s.tz)) || !s.tz[0]) {
+    return "tz missing or too long";
+  }
+  if (!memchr(s.ntp1, '\0', sizeof(s.ntp1)) || !memchr(s.ntp2, '\0', sizeof(s.ntp2)) || !s.ntp1[0]) {
+    return "ntp server missing or too long";
+  }
+  if (abs(s.gmtOffset) > SETTINGS_OFFSET_MAX || abs(s.dstOffset) > SETTINGS_OFFSET_MAX) {
+    return "offset out of range";
+  }
+  if (s.showHours >> 24) {
+    return "lightshow hour out of range";
+  }
+  if (s.brightness > DISPLAY_BRIGHT_MAX) {
+    return "brightness out of range";
+  }
+  if (!pinFree(s.buttonPin) || !pinFree(s.zcPin) || s.buttonPin == s.zcPin) {
+    return "bad pin";
+  }
+  return nullptr;
+}
+
+//Portal fields, created by settingsPortal, refreshed from cfg after every change
+static WiFiManagerParameter *fields[9];
+enum { F_BRIGHT, F_TZ, F_NTP1, F_NTP2, F_GMT, F_DST, F_SHOWS, F_BUTTON, F_ZC };
+
+static void fieldSet(int f, const char *value) {
+  if (fields[f]) {
+    fields[f]->setValue(value, fields[f]->getValueLength());
+  }
+}
+
+static void fieldSet(int f, long value) {
+  char num[12];
+  snprintf(num, sizeof(num), "%ld", value);
+  fieldSet(f, num);
+}
+
+static void fieldsRefresh() {
+  char hours[72] = "";
+  size_t len = 0;
+  for (int h = 0; h < 24; h++) {
+    if (cfg.showHours & (1UL << h)) {
+      len += snprintf(hours + len, sizeof(hours) - len, len ? ",%d" : "%d", h);
+    }
+  }
+  fieldSet(F_BRIGHT, (long)cfg.brightness);
+  fieldSet(F_TZ, cfg.tz);
+  fieldSet(F_NTP1, cfg.ntp1);
+  fieldSet(F_NTP2, cfg.ntp2);
+  fieldSet(F_GMT, (long)cfg.gmtOffset);
+  fieldSet(F_DST, (long)cfg.dstOffset);
+  fieldSet(F_SHOWS, hours);
+  fieldSet(F_BUTTON, (long)cfg.buttonPin);
+  fieldSet(F_ZC, (long)cfg.zcPin);
+}
+
+const char *settingsApply(const settings_t &next) {
+  const char *error = validate(next);
+  if (error) {
+    return error;
+  }
+  settings_t prev = cfg;
+  if (memcmp(&prev, &next, sizeof(settings_t)) == 0) {
+    return nullptr;
+  }
+  cfg = next;
+  save();
+
+  if (cfg.brightness != prev.brightness) {
+    displaySetBrightness(cfg.brightness);
+  }
+  bool ntp = strcmp(cfg.ntp1, prev.ntp1) || strcmp(cfg.ntp2, prev.ntp2) ||
+             cfg.gmtOffset != prev.gmtOffset || cfg.dstOffset != prev.dstOffset;
+  if (ntp) {
+    configTime(cfg.gmtOffset, cfg.dstOffset, cfg.ntp1, cfg.ntp2); // restarts sntp, also sets a fixed offset TZ
+  }
+  if (ntp || strcmp(cfg.tz, prev.tz)) {
+    timeSetZone(cfg.tz);
+    schedRebuild(time(nullptr)); // daily rules are local time
+  }
+  if (cfg.showHours != prev.showHours && schedSetHours(SCHED_LIGHTSHOW, cfg.showHours)) {
+    Serial.println("settings: scheduler full, some lightshows dropped");
+  }
+  if (cfg.buttonPin != prev.buttonPin || cfg.zcPin != prev.zcPin) {
+    Serial.println("settings: pins change on the next boot");
+  }
+  fieldsRefresh();
+  return nullptr;
+}
+
+//Comma separated hours to a mask, false on anything but 0-23
+static bool parseHours(const char *text, uint32_t &mask) {
+  mask = 0;
+  while (*text) {
+    char *end;
+    long h = strtol(text, &end, 10);
+    if (end == text || h < 0 || h > 23) {
+      return false;
+    }
+    mask |= 1UL << h;
+    text = end;
+    while (*text == ',' || *text == ' ') {
+      text++;
+    }
+  }
+  return true;
+}
+
+static void onPortalSave() {
+  settings_t next = cfg;
+  strlcpy(next.tz, fields[F_TZ]->getValue(), sizeof(next.tz));
+  strlcpy(next.ntp1, fields[F_NTP1]->getValue(), sizeof(next.ntp1));
+  strlcpy(next.ntp2, fields[F_NTP2]->getValue(), sizeof(next.ntp2));
+  next.gmtOffset = atol(fields[F_GMT]->getValue());
+  next.dstOffset = atol(fields[F_DST]->getValue());
+  next.brightness = constrain(atoi(fields[F_BRIGHT]->getValue()), 0, 255);
+  next.buttonPin = constrain(atoi(fields[F_BUTTON]->getValue()), 0, 255);
+  next.zcPin = constrain(atoi(fields[F_ZC]->getValue()), 0, 255);
+  const char *error = parseHours(fields[F_SHOWS]->getValue(), next.showHours) ? settingsApply(next)
+                                                                             : "bad lightshow hours";
+  if (error) {
+    Serial.printf("settings: not saved, %s\n", error);
+    fieldsRefresh(); // the form shows what is in use
+  }
+}
+
+void settingsPortal(WiFiManager &wm) {
+  fields[F_BRIGHT] = new WiFiManagerParameter("brightness", "Brightness 0-8", "", 1, "type='number' min='0' max='8'");
+  fields[F_TZ] = new WiFiManagerParameter("tz", "Timezone (POSIX TZ rule)", "", TZ_MAX_LEN - 1);
+  fields[F_NTP1] = new WiFiManagerParameter("ntp1", "NTP server", "", SETTINGS_NTP_LEN - 1);
+  fields[F_NTP2] = new WiFiManagerParameter("ntp2", "NTP server 2", "", SETTINGS_NTP_LEN - 1);
+  fields[F_GMT] = new WiFiManagerParameter("gmt", "GMT offset (s)", "", 6, "type='number'");
+  fields[F_DST] = new WiFiManagerParameter("dst", "Daylight offset (s)", "", 6, "type='number'");
+  fields[F_SHOWS] = new WiFiManagerParameter("shows", "Lightshow hours, e.g. 0,12", "", 71);
+  fields[F_BUTTON] = new WiFiManagerParameter("btnpin", "Button pin (after reboot)", "", 2, "type='number' min='0' max='21'");
+  fields[F_ZC] = new WiFiManagerParameter("zcpin", "Zero cross pin (after reboot)", "", 2, "type='number' min='0' max='21'");
+  for (WiFiManagerParameter *field : fields) {
+    wm.addParameter(field);
+  }
+  fieldsRefresh();
+  //own params page, keeping the update entry setParamsPage() would drop
+  static const char *menu[] = {"wifi", "param", "info", "exit", "sep", "update"};
+  wm.setMenu(menu, sizeof(menu) / sizeof(menu[0]));
+  wm.setSaveParamsCallback(onPortalSave);
+}
@@ -0,0 +1,188 @@
+#include "sse.h"
+#include <lwip/sockets.h>
+
+static const char SSE_HEAD[] PROGMEM =
+  "HTTP/1.1 200 OK\r\n"
+  "Content-Type: text/event-stream\r\n"
+  "Cache-Control: no-cache\r\n"
+  "Connection: keep-alive\r\n"
+  "Access-Control-Allow-Origin: *\r\n\r\n"
+  "retry: 2000\n\n";
+static const char SSE_KEEPALIVE[] PROGMEM = ":\n\n";
+
+/*
+Every client has its own small frame ring, filled by the display task and drained by the pump
+task. A full ring drops its oldest frame, so a slow client only loses intermediate frames and
+the display task never waits. The message being sent is kept with its offset, a socket that
+takes only part of it continues there on the next pump.
+*/
+struct sse_client_t {
+  bool active;
+  WiFiClient client;         // keeps the socket open after the web server lets go of it
+  frame_t queue[SSE_QUEUE_LEN];
+  uint8_t head, count;
+  uint32_t dropped;
+  char out[sizeof(SSE_HEAD)]; // message in flight, the header is the longest
+  uint8_t outLen, outOff;
+  uint32_t lastSendMillis;   // last time the socket accepted bytes
+};
+
+static sse_client_t clients[SSE_MAX_CLIENTS];
+static portMUX_TYPE sseMux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t pumpTask = nullptr;
+static uint32_t pumpBit = 0;
+static volatile uint8_t active = 0;
+
+static void push(sse_client_t &c, const frame_t &frame) {
+  if (c.count == SSE_QUEUE_LEN) {
+    //drop oldest
+    c.head = (c.head + 1) % SSE_QUEUE_LEN;
+    c.count--;
+    c.dropped++;
+  }
+  c.queue[(c.head + c.count) % SSE_QUEUE_LEN] = frame;
+  c.count++;
+}
+
+//Display task, after every commit
+static void onCommit(const frame_t &frame) {
+  if (!active) {
+    return;
+  }
+  portENTER_CRITICAL(&sseMux);
+  for (int i = 0; i < SSE_MAX_CLIENTS; i++) {
+    if (clients[i].active) {
+      push(clients[i], frame);
+    }
+  }
+  portEXIT_CRITICAL(&sseMux);
+  xTaskNotify(pumpTask, pumpBit, eSetBits);
+}
+
+static uint8_t format(char *out, size_t size, const frame_t &frame, uint32_t dropped) {
+  char digits[NUM_TUBES * 5 + 1];
+  size_t n = 0;
+  for (int i = 0; i < NUM_TUBES; i++) {
+    if (i) {
+      digits[n++] = ',';
+    }
+    if (frame.digit[i] == DIGIT_BLANK) {
+      memcpy(digits + n, "null", 4);
+      n += 4;
+    }
+    else {
+      digits[n++] = '0' + frame.digit[i];
+    }
+  }
+  digits[n] = '\0';
+  int len = snprintf(out, size, "event: frame\ndata: {\"d\":[%s],\"a\":%lu,\"b\":%lu,\"dropped\":%lu}\n\n",
+                     digits, (unsigned long)frame.a, (unsigned long)frame.b, (unsigned long)dropped);
+  return len < (int)size ? len : size - 1;
+}
+
+//Pump task only, the socket is closed before the slot is handed back to handleEvents
+static void drop(sse_client_t &c) {
+  c.client.stop();
+  c.client = WiFiClient();
+  portENTER_CRITICAL(&sseMux);
+  c.active = false;
+  c.count = 0;
+  active--;
+  portEXIT_CRITICAL(&sseMux);
+}
+
+//Portal task, only fills a free slot, the client belongs to the pump task once it is active
+
+static void handleEvents(WebServer &server) {
+  int slot = -1;
+  for (int i = 0; i < SSE_MAX_CLIENTS; i++) {
+    if (!clients[i].active) {
+      slot = i;
+      break;
+    }
+  }
+  if (slot < 0) {
+    server.send_P(503, PSTR("text/plain"), PSTR("too many event clients"));
+    return;
+  }
+  sse_client_t &c = clients[slot];
+  c.client = server.client();
+  c.client.setNoDelay(true);
+  //headers are written by hand, the web server forgets the client after this handler
+  memcpy_P(c.out, SSE_HEAD, sizeof(SSE_HEAD) - 1);
+  c.outLen = sizeof(SSE_HEAD) - 1;
+  c.outOff = 0;
+  c.head = 0;
+  c.count = 0;
+  c.dropped = 0;
+  c.lastSendMillis = millis();
+  portENTER_CRITICAL(&sseMux);
+  push(c, displayFrame()); // start with what the tubes show now
+  c.active = true;
+  active++;
+  portEXIT_CRITICAL(&sseMux);
+  xTaskNotify(pumpTask, pumpBit, eSetBits); // the header goes out from the pump task
+}
+
+void sseBegin(TaskHandle_t pump, uint32_t notifyBit) {
+  pumpTask = pump;
+  pumpBit = notifyBit;
+  displayOnCommit(onCommit);
+}
+
+void sseRoutes(WebServer &server) {
+  server.on(F("/events"), HTTP_GET, [&server]() { handleEvents(server); });
+}
+
+void ssePump() {
+  uint32_t now = millis();
+  for (int i = 0; i < SSE_MAX_CLIENTS; i++) {
+    sse_client_t &c = clients[i];
+    if (!c.active) {
+      continue;
+    }
+    while (true) {
+      if (c.outOff == c.outLen) {
+        //next message, a frame or a keepalive when idle
+        frame_t frame;
+        bool have = false;
+        uint32_t dropped;
+        portENTER_CRITICAL(&sseMux);
+        if (c.count) {
+          frame = c.queue[c.head];
+          c.head = (c.head + 1) % SSE_QUEUE_LEN;
+          c.count--;
+          have = true;
+        }
+        dropped = c.dropped;
+        portEXIT_CRITICAL(&sseMux);
+        if (have) {
+          c.outLen = format(c.out, sizeof(c.out), frame, dropped);
+        }
+        else if (now - c.lastSendMillis >= SSE_KEEPALIVE_MS) {
+          strcpy_P(c.out, SSE_KEEPALIVE);
+          c.outLen = strlen(c.out);
+        }
+        else {
+          break;
+        }
+        c.outOff = 0;
+      }
+      int sent = send(c.client.fd(), c.out + c.outOff, c.outLen - c.outOff, MSG_DONTWAIT);
+      if (sent > 0) {
+        c.outOff += sent;
+        c.lastSendMillis = now;
+        continue;
+      }
+      if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && now - c.lastSendMillis < SSE_STALL_MS) {
+        break; // socket buffer full, frames keep coalescing in the ring meanwhile
+      }
+      drop(c);
+      break;
+    }
+  }
+}
+
+uint8_t sseClients() {
+  return active;
+}
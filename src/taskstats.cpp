@@ -0,0 +1,40 @@
+#include "taskstats.h"
+#include <esp_timer.h>
+
+struct task_stats_t {
+  const char *name;
+  TaskHandle_t handle;
+  volatile uint32_t busyUs; // work time since the last report, written by the owning task only
+};
+
+static task_stats_t tasks[TASK_STATS_MAX];
+static int taskCount = 0;
+static int64_t reportUs = 0;
+
+int taskStatsAdd(const char *name, TaskHandle_t handle) {
+  if (taskCount >= TASK_STATS_MAX) {
+    return -1;
+  }
+  tasks[taskCount] = {name, handle, 0};
+  return taskCount++;
+}
+
+void taskBusy(int slot, uint32_t us) {
+  if (slot >= 0) {
+    tasks[slot].busyUs += us;
+  }
+}
+
+void taskStatsPrint(Print &out) {
+  int64_t now = esp_timer_get_time();
+  int64_t elapsed = now - reportUs;
+  reportUs = now;
+  for (int i = 0; i < taskCount; i++) {
+    //swap out the counter, a lost update from the owner only skews one report
+    uint32_t busy = tasks[i].busyUs;
+    tasks[i].busyUs = 0;
+    out.printf("task %-8s stack free %5u B, cpu %3lu.%lu%%\n", tasks[i].name,
+               (unsigned)uxTaskGetStackHighWaterMark(tasks[i].handle),
+               (unsigned long)(busy * 100ULL / elapsed), (unsigned long)(busy * 1000ULL / elapsed % 10));
+  }
+}
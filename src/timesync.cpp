@@ -0,0 +1,44 @@
+#include "timesync.h"
+#include <esp_sntp.h>
+#include <sys/time.h>
+#include <esp_timer.h>
+
+static time_sync_t stats;
+static int64_t lastSyncUs = 0; // esp_timer time of the last sync
+static char tz[TZ_MAX_LEN] = "";
+
+//Replaces the weak lwip hook, sets the time like the default does and measures the step first
+extern "C" void sntp_sync_time(struct timeval *tv) {
+  struct timeval now;
+  gettimeofday(&now, nullptr);
+  int64_t offset = (int64_t)(tv->tv_sec - now.tv_sec) * 1000000 + (tv->tv_usec - now.tv_usec);
+  settimeofday(tv, nullptr);
+  int64_t mono = esp_timer_get_time();
+  if (stats.count) {
+    //the offset built up since the last sync is the drift over that time
+    stats.driftPpm = (float)offset * 1e6f / (float)(mono - lastSyncUs);
+  }
+  lastSyncUs = mono;
+  stats.offsetUs = offset;
+  stats.last = tv->tv_sec;
+  stats.count++;
+  sntp_set_sync_status(SNTP_SYNC_STATUS_COMPLETED);
+}
+
+const time_sync_t &timeSyncStats() {
+  return stats;
+}
+
+bool timeSetZone(const char *rule) {
+  if (strlen(rule) >= sizeof(tz)) {
+    return false;
+  }
+  strcpy(tz, rule);
+  setenv("TZ", tz, 1);  //  Now adjust the TZ.  Clock settings are adjusted to show the new local time
+  tzset();
+  return true;
+}
+
+const char *timeZone() {
+  return tz;
+}
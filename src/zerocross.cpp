@@ -0,0 +1,245 @@
+#include "zerocross.h"
+#include "power.h"
+#include <esp_timer.h>
+
+/*
+Before lock the edge ISR switches phases itself, debounced, like the plain CHANGE interrupt did.
+Once ZC_LOCK_EDGES periods in range were seen, the timer takes over: it fires at the predicted
+rising and falling edges, the edge ISR only measures the error against the prediction and
+steers period (1/16 of the error) and phase (1/4 of the error). Edges outside the window are
+dropped, missing edges are bridged by the timer running on the last period. When the edges stay out
+of the window, after a long dropout or a detector back at another phase, the lock is dropped and
+acquisition starts over.
+Dimming is a second one shot armed on every phase switch that blanks the tubes part way into the
+half wave, under the same mux so a late blank can't cut into the next phase.
+The timers are esp_timers rather than a timer group, the group timers run from APB which DFS
+scales and light sleep stops, esp_timer is kept on time by the power manager.
+*/
+static uint8_t zcPin;
+static zc_phase_t onPhase;
+static zc_blank_t onBlank;
+static esp_timer_handle_t timer = nullptr;
+static esp_timer_handle_t blankTimer = nullptr;
+static portMUX_TYPE zcMux = portMUX_INITIALIZER_UNLOCKED;
+
+static volatile bool locked = false;
+static int32_t periodQ4 = 0;         // mains period in 1/16 us
+static int32_t fallUs = 0;           // falling edge offset from the rising one
+static int64_t predRiseUs = 0;       // predicted rising edge of the current cycle
+static int64_t nextEdgeUs = 0;       // edge the timer is armed for
+static bool nextRise = false;
+static int64_t lastValidUs = 0;
+static int missed = 0;               // edges outside the window in a row
+static volatile uint16_t lit = ZC_LIT_FULL;
+static int64_t blankAtUs = 0;        // end of the lit part of the current half wave
+static bool blankArmed = false;
+
+//acquisition
+static int64_t lastRiseUs = 0;
+static int64_t lastEdgeUs = 0;
+static int64_t acqSum = 0;
+static int acqCount = 0;
+
+static volatile uint32_t rejected = 0;
+
+static inline int32_t period() {
+  return periodQ4 >> 4;
+}
+
+//Arms the timer for nextEdgeUs, under zcMux so the timer task and the edge ISR can't arm over each
+//other, reads the clock itself since the shift-out before it takes a while
+static void IRAM_ATTR arm() {
+  int64_t wait = nextEdgeUs - esp_timer_get_time();
+  esp_timer_stop(timer);
+  esp_timer_start_once(timer, wait > 50 ? wait : 50);
+}
+
+//Switches to the half wave and arms its blank, under zcMux
+static void IRAM_ATTR switchPhase(bool high) {
+  int64_t now = esp_timer_get_time();
+  onPhase(high);
+  uint16_t l = lit;
+  blankArmed = l && l < ZC_LIT_FULL;
+  if (blankArmed) {
+    int32_t half = period() ? (locked ? (high ? fallUs : period() - fallUs) : period() / 2) : ZC_HALF_DEFAULT_US;
+    int64_t wait = (int64_t)half * l / ZC_LIT_FULL;
+    blankAtUs = now + wait;
+    esp_timer_stop(blankTimer);
+    esp_timer_start_once(blankTimer, wait);
+  }
+}
+
+static void onBlankTimer(void *) {
+  portENTER_CRITICAL(&zcMux);
+  //one that fired just before a phase switch and waited for the mux belongs to the last half wave
+  if (blankArmed && esp_timer_get_time() >= blankAtUs) {
+    blankArmed = false;
+    onBlank();
+  }
+  portEXIT_CRITICAL(&zcMux);
+}
+
+static void onTimer(void *) {
+  portENTER_CRITICAL(&zcMux);
+  if (!locked) {
+    portEXIT_CRITICAL(&zcMux);
+    return;
+  }
+  bool high = nextRise;
+  if (nextRise) {
+    predRiseUs = nextEdgeUs;
+    nextEdgeUs = predRiseUs + fallUs;
+  }
+  else {
+    nextEdgeUs = predRiseUs + period();
+  }
+  nextRise = !nextRise;
+  //shifted out under the mux, with the lock checked above, so the edge ISR can't drop the lock and
+  //start its own shift-out halfway through this one
+  switchPhase(high);
+  arm();
+  portEXIT_CRITICAL(&zcMux);
+}
+
+//Drops the lock and stops the timer, acquire() starts over from the next edge
+static void IRAM_ATTR unlock() {
+  locked = false;
+  esp_timer_stop(timer);
+  acqSum = 0;
+  acqCount = 0;
+  lastRiseUs = 0;
+  missed = 0;
+}
+
+//Returns true if the edge should switch the phase
+static bool IRAM_ATTR acquire(int64_t now, bool high) {
+  if (now - lastEdgeUs < ZC_DEBOUNCE_US) {
+    rejected++;
+    return false;
+  }
+  lastEdgeUs = now;
+  if (!high) {
+    if (lastRiseUs) {
+      fallUs = now - lastRiseUs;
+    }
+    return true;
+  }
+  int64_t dt = now - lastRiseUs;
+  lastRiseUs = now;
+  if (dt < ZC_MIN_US || dt > ZC_MAX_US) {
+    acqSum = 0;
+    acqCount = 0;
+    return true;
+  }
+  acqSum += dt;
+  if (++acqCount < ZC_LOCK_EDGES) {
+    return true;
+  }
+  //lock, the timer continues from this rising edge
+  periodQ4 = (acqSum << 4) / acqCount;
+  if (fallUs <= 0 || fallUs >= period()) {
+    fallUs = period() / 2;
+  }
+  predRiseUs = now;
+  nextEdgeUs = now + fallUs;
+  nextRise = false;
+  lastValidUs = now;
+  locked = true;
+  return true;
+}
+
+//Returns true if the armed edge moved and the timer needs arming again
+static bool IRAM_ATTR track(int64_t now, bool high) {
+  //error against the nearest predicted edge of this kind
+  int64_t pred = predRiseUs + (high ? 0 : fallUs);
+  int32_t err = now - pred;
+  if (err > period() / 2) {
+    err -= period();
+  }
+  else if (err < -period() / 2) {
+    err += period();
+  }
+  if (err > ZC_WINDOW_US || err < -ZC_WINDOW_US) {
+    rejected++;
+    //the flywheel drifted off or the detector came back at another phase, no edge gets in again
+    if (++missed >= ZC_LOST_EDGES || now - lastValidUs > (int64_t)ZC_HOLDOVER_MS * 1000) {
+      unlock();
+    }
+    return false;
+  }
+  missed = 0;
+  lastValidUs = now;
+  if (high) {
+    periodQ4 += err;             // 1/16 of the error into the period
+    predRiseUs += err / 4;       // and a quarter into the phase, the armed edge is re-armed with it
+    nextEdgeUs += err / 4;
+    if (periodQ4 < (ZC_MIN_US << 4) || periodQ4 > (ZC_MAX_US << 4)) {
+      //steered out of range, start over
+      unlock();
+      return false;
+    }
+    return err / 4 != 0;
+  }
+  fallUs += err / 8;
+  return false;
+}
+
+static void IRAM_ATTR onEdge() {
+  int64_t now = esp_timer_get_time();
+  bool high = powerRearm(zcPin);
+  bool shift = false;
+  bool start = false;
+  portENTER_CRITICAL_ISR(&zcMux);
+  if (locked) {
+    start = track(now, high);
+  }
+  if (!locked) {
+    //acquiring, or the lock was just dropped and this edge is the first of the new acquisition
+    shift = acquire(now, high);
+    start = locked;
+  }
+  if (shift) {
+    switchPhase(high); // before lock only the edges shift out
+  }
+  if (start) {
+    arm();
+  }
+  portEXIT_CRITICAL_ISR(&zcMux);
+}
+
+void zcBegin(uint8_t pin, zc_phase_t phase, zc_blank_t blank) {
+  zcPin = pin;
+  onPhase = phase;
+  onBlank = blank;
+  esp_timer_create_args_t args = {};
+  args.callback = onTimer;
+  args.name = "zc";
+  esp_timer_create(&args, &timer);
+  args.callback = onBlankTimer;
+  args.name = "zc_blank";
+  esp_timer_create(&args, &blankTimer);
+  //level interrupt flipped on every edge, so the detector also wakes from light sleep
+  powerAttachWake(pin, onEdge);
+}
+
+void zcSetLit(uint16_t level) {
+  lit = level > ZC_LIT_FULL ? ZC_LIT_FULL : level;
+}
+
+bool zcLocked() {
+  //64 bit, the edge ISR could tear it between the two word loads
+  portENTER_CRITICAL(&zcMux);
+  bool lock = locked;
+  int64_t valid = lastValidUs;
+  portEXIT_CRITICAL(&zcMux);
+  return lock && esp_timer_get_time() - valid < (int64_t)ZC_HOLDOVER_MS * 1000;
+}
+
+float zcFrequency() {
+  int32_t p = periodQ4;
+  return p ? 16e6f / p : 0;
+}
+
+uint32_t zcRejected() {
+  return rejected;
+}
@@ -0,0 +1,160 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <frame.h>
+#include <lightshow.h>
+#include <schedwheel.h>
+
+//Microbenchmarks of the hot paths, cost per operation is printed for tracking, nothing is asserted
+//on the time since hosts differ. Run with `pio test -e native -f test_bench -v` to see the numbers.
+#define BENCH_OPS 200000
+
+static volatile uint32_t sink; // keeps results alive
+
+static void report(const char *name, std::chrono::steady_clock::duration took, uint32_t ops) {
+  char line[80];
+  double ns = std::chrono::duration<double, std::nano>(took).count() / ops;
+  snprintf(line, sizeof(line), "%-16s %10.1f ns/op", name, ns);
+  TEST_MESSAGE(line);
+}
+
+//Times fn(i) for i in 0..ops-1
+template <typename F>
+static void bench(const char *name, uint32_t ops, F fn) {
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < ops; i++) {
+    fn(i);
+  }
+  report(name, std::chrono::steady_clock::now() - start, ops);
+}
+
+void setUp() {
+  setenv("TZ", "CET-1CEST,M3.5.0,M10.5.0/3", 1);
+  tzset();
+}
+
+void tearDown() {
+}
+
+//digits to pin words, once per shown second
+static void bench_frame_encode() {
+  uint8_t digit[NUM_TUBES] = {1, 2, 3, 4, 5, 6};
+  frame_t frame;
+  bench("frameDigits", BENCH_OPS, [&](uint32_t i) {
+    digit[0] = i % 10;
+    frameDigits(frame, digit);
+    sink += frame.a ^ frame.b;
+  });
+  bench("frameRaw", BENCH_OPS, [&](uint32_t i) {
+    frameRaw(frame, i, ~i);
+    sink += frame.digit[0];
+  });
+}
+
+//tm to tube digits, the clock and stopwatch modes
+static void bench_digits() {
+  struct tm now;
+  memset(&now, 0, sizeof(now));
+  uint8_t digit[NUM_TUBES];
+  bench("digitsClock", BENCH_OPS, [&](uint32_t i) {
+    now.tm_sec = i % 60;
+    digitsClock(digit, now);
+    sink += digit[0];
+  });
+  bench("digitsElapsed", BENCH_OPS, [&](uint32_t i) {
+    digitsElapsed(digit, (int64_t)i * 10000);
+    sink += digit[0];
+  });
+}
+
+//precomputing the show and picking the step every 10ms tick
+static void bench_lightshow() {
+  struct tm now;
+  memset(&now, 0, sizeof(now));
+  frame_t shown;
+  frameAll(shown, 8);
+  std::vector<show_step_t> show;
+  bench("showBuild", 2000, [&](uint32_t) {
+    showBuild(show, shown, now);
+    sink += show.size();
+  });
+  uint32_t total = 0;
+  for (const show_step_t &s : show) {
+    total += s.ms;
+  }
+  //whole show at the mode tick rate, repeated
+  uint32_t ticks = total / 10;
+  uint32_t runs = BENCH_OPS / ticks + 1;
+  size_t step = 0;
+  uint32_t started = 0;
+  bench("showAdvance", runs * ticks, [&](uint32_t i) {
+    uint32_t tick = i % ticks;
+    if (tick == 0) {
+      step = 0;
+      started = 0;
+    }
+    step = showAdvance(show, step, started, tick * 10);
+    sink += step;
+  });
+}
+
+//local time conversions, every rebuild and every daily rule that fires
+static void bench_time() {
+  sched_rule_t noon = {SCHED_DAILY, SCHED_LIGHTSHOW, SCHED_EVERYDAY, 12, 0, 0, 0};
+  const time_t base = 1711796400;
+  bench("schedNextDaily", 20000, [&](uint32_t i) {
+    sink += schedNextDaily(noon, base + i * 3607);
+  });
+  struct tm lt;
+  bench("localtime_r", 20000, [&](uint32_t i) {
+    time_t t = base + i * 3607;
+    localtime_r(&t, &lt);
+    sink += lt.tm_hour;
+  });
+}
+
+//one scheduler second with the pool full of daily rules
+static void bench_wheel() {
+  sched_wheel_t w;
+  wheelReset(w, 1711796400);
+  for (int i = 0; i < SCHED_MAX; i++) {
+    wheelAdd(w, i, w.cur + 1 + i * 5400);
+  }
+  bench("wheelStep", 1000000, [&](uint32_t) {
+    uint32_t t = w.cur;
+    for (int8_t i = wheelStep(w); i >= 0;) {
+      int8_t n = w.next[i];
+      wheelAdd(w, i, t + 86400);
+      sink += i;
+      i = n;
+    }
+  });
+}
+
+int runTests() {
+  UNITY_BEGIN();
+  RUN_TEST(bench_frame_encode);
+  RUN_TEST(bench_digits);
+  RUN_TEST(bench_lightshow);
+  RUN_TEST(bench_time);
+  RUN_TEST(bench_wheel);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+
+void setup() {
+  delay(2000); // let the serial monitor attach
+  runTests();
+}
+
+void loop() {
+}
+#else
+int main() {
+  return runTests();
+}
+#endif
@@ -0,0 +1,264 @@
+#include <unity.h>
+#include <stdlib.h>
+#include <string.h>
+#include <frame.h>
+#include <lightshow.h>
+#include <schedwheel.h>
+#include <stopwatch.h>
+
+//Saturday 2024-03-30 12:00 CET, the night before the switch to CEST
+#define SAT_NOON 1711796400UL
+
+static struct tm clockTime(int hour, int min, int sec) {
+  struct tm t;
+  memset(&t, 0, sizeof(t));
+  t.tm_hour = hour;
+  t.tm_min = min;
+  t.tm_sec = sec;
+  return t;
+}
+
+void setUp() {
+  setenv("TZ", "CET-1CEST,M3.5.0,M10.5.0/3", 1);
+  tzset();
+}
+
+void tearDown() {
+}
+
+//FRAME///////////////////////////////////////////////////////////////////////////////////////////////////
+static void test_frame_digits_pins() {
+  //one digit per tube, tube 5/4 at 0, 3/2 at 10, 1/0 at 20, odd tubes on A
+  const uint8_t digit[NUM_TUBES] = {1, 2, 3, 4, 5, 6};
+  frame_t frame;
+  frameDigits(frame, digit);
+  TEST_ASSERT_EQUAL_HEX32((1UL << 6) | (1UL << 14) | (1UL << 22), frame.a);
+  TEST_ASSERT_EQUAL_HEX32((1UL << 5) | (1UL << 13) | (1UL << 21), frame.b);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(digit, frame.digit, NUM_TUBES);
+}
+
+static void test_frame_blank() {
+  uint8_t digit[NUM_TUBES];
+  memset(digit, DIGIT_BLANK, sizeof(digit));
+  digit[3] = 0;
+  frame_t frame;
+  frameDigits(frame, digit);
+  TEST_ASSERT_EQUAL_HEX32(1UL << 10, frame.a);
+  TEST_ASSERT_EQUAL_HEX32(0, frame.b);
+  frameClear(frame);
+  TEST_ASSERT_EQUAL_HEX32(0, frame.a | frame.b);
+  TEST_ASSERT_EQUAL_UINT8(DIGIT_BLANK, frame.digit[3]);
+}
+
+static void test_frame_raw_round_trip() {
+  for (int d = 0; d <= 9; d++) {
+    frame_t frame, raw;
+    frameAll(frame, d);
+    frameRaw(raw, frame.a, frame.b);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(frame.digit, raw.digit, NUM_TUBES);
+  }
+  //two cathodes on one tube is not a digit
+  frame_t raw;
+  frameRaw(raw, (1UL << 3) | (1UL << 4), 0);
+  TEST_ASSERT_EQUAL_UINT8(DIGIT_BLANK, raw.digit[5]);
+}
+
+//DIGITS//////////////////////////////////////////////////////////////////////////////////////////////////
+static void test_digits_clock_date() {
+  uint8_t digit[NUM_TUBES];
+  digitsClock(digit, clockTime(23, 59, 7));
+  const uint8_t clock[NUM_TUBES] = {7, 0, 9, 5, 3, 2};
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(clock, digit, NUM_TUBES);
+  struct tm day = clockTime(0, 0, 0);
+  day.tm_year = 124;
+  day.tm_mon = 2;
+  day.tm_mday = 31;
+  digitsDate(digit, day);
+  const uint8_t date[NUM_TUBES] = {4, 2, 3, 0, 1, 3};
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(date, digit, NUM_TUBES);
+}
+
+static void test_digits_elapsed_duration() {
+  uint8_t digit[NUM_TUBES];
+  digitsElapsed(digit, (12 * 60 + 34) * 1000000LL + 560000); // 12:34.56
+  const uint8_t elapsed[NUM_TUBES] = {6, 5, 4, 3, 2, 1};
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(elapsed, digit, NUM_TUBES);
+  digitsDuration(digit, 101 * 3600 + 2 * 60 + 3); // hours wrap at 100
+  const uint8_t duration[NUM_TUBES] = {3, 0, 2, 0, 1, 0};
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(duration, digit, NUM_TUBES);
+}
+
+static void test_digits_percent() {
+  uint8_t digit[NUM_TUBES];
+  digitsPercent(digit, 7);
+  const uint8_t seven[NUM_TUBES] = {7, DIGIT_BLANK, DIGIT_BLANK, DIGIT_BLANK, DIGIT_BLANK, DIGIT_BLANK};
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(seven, digit, NUM_TUBES);
+  digitsPercent(digit, 100);
+  const uint8_t full[NUM_TUBES] = {0, 0, 1, DIGIT_BLANK, DIGIT_BLANK, DIGIT_BLANK};
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(full, digit, NUM_TUBES);
+}
+
+//LIGHTSHOW///////////////////////////////////////////////////////////////////////////////////////////////
+static void test_show_ends_on_time() {
+  frame_t shown;
+  digitsClock(shown.digit, clockTime(11, 59, 59));
+  frameDigits(shown, shown.digit);
+  std::vector<show_step_t> show;
+  showBuild(show, shown, clockTime(12, 34, 56));
+  TEST_ASSERT_GREATER_THAN(100, show.size());
+  //starts blinking what was shown
+  TEST_ASSERT_EQUAL_HEX32(0, show[0].a | show[0].b);
+  TEST_ASSERT_EQUAL_HEX32(shown.a, show[1].a);
+  TEST_ASSERT_EQUAL_HEX32(shown.b, show[1].b);
+  //the hours, minutes and seconds tens are shifted in from the right
+  frame_t last;
+  frameRaw(last, show.back().a, show.back().b);
+  const uint8_t time[NUM_TUBES] = {DIGIT_BLANK, 5, 4, 3, 2, 1};
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(time, last.digit, NUM_TUBES);
+}
+
+static void test_show_advance() {
+  std::vector<show_step_t> show = {{0, 0, 100}, {1, 1, 50}, {2, 2, 10}};
+  uint32_t started = 1000;
+  TEST_ASSERT_EQUAL(0, showAdvance(show, 0, started, 1099));
+  TEST_ASSERT_EQUAL(1, showAdvance(show, 0, started, 1100));
+  TEST_ASSERT_EQUAL_UINT32(1100, started);
+  //a late tick skips steps but keeps the show timing
+  TEST_ASSERT_EQUAL(2, showAdvance(show, 1, started, 1155));
+  TEST_ASSERT_EQUAL_UINT32(1150, started);
+  TEST_ASSERT_EQUAL(show.size(), showAdvance(show, 2, started, 1160));
+}
+
+//SCHEDULER///////////////////////////////////////////////////////////////////////////////////////////////
+static void test_next_daily_dst() {
+  //the day after is 23h long
+  sched_rule_t noon = {SCHED_DAILY, SCHED_LIGHTSHOW, SCHED_EVERYDAY, 12, 0, 0, 0};
+  TEST_ASSERT_EQUAL_UINT32(SAT_NOON, schedNextDaily(noon, SAT_NOON - 1));
+  TEST_ASSERT_EQUAL_UINT32(SAT_NOON + 23 * 3600, schedNextDaily(noon, SAT_NOON));
+  //Monday only
+  sched_rule_t monday = {SCHED_DAILY, SCHED_ALARM, 1 << 1, 12, 0, 0, 0};
+  TEST_ASSERT_EQUAL_UINT32(SAT_NOON + 47 * 3600, schedNextDaily(monday, SAT_NOON));
+}
+
+static void test_wheel_fires_on_time() {
+  //one timer on every level, the overflow list and one overdue
+  const uint32_t now = SAT_NOON + 17;
+  const uint32_t due[] = {now + 1, now + 300, now + 20000, now + 2000000, now - 5};
+  const int n = sizeof(due) / sizeof(due[0]);
+  sched_wheel_t w;
+  wheelReset(w, now);
+  for (int i = 0; i < n; i++) {
+    wheelAdd(w, i, due[i]);
+  }
+  uint32_t fired[n];
+  memset(fired, 0, sizeof(fired));
+  while (w.cur <= now + 2000000) {
+    uint32_t t = w.cur;
+    for (int8_t i = wheelStep(w); i >= 0; i = w.next[i]) {
+      TEST_ASSERT_EQUAL_UINT32(0, fired[i]);
+      fired[i] = t;
+    }
+  }
+  for (int i = 0; i < n - 1; i++) {
+    TEST_ASSERT_EQUAL_UINT32(due[i], fired[i]);
+  }
+  TEST_ASSERT_EQUAL_UINT32(now, fired[n - 1]);
+}
+
+static void test_wheel_daily_repeat() {
+  //re-added from the fired list like the scheduler does, across the short day
+  sched_rule_t noon = {SCHED_DAILY, SCHED_LIGHTSHOW, SCHED_EVERYDAY, 12, 0, 0, 0};
+  sched_wheel_t w;
+  wheelReset(w, SAT_NOON - 100);
+  wheelAdd(w, 0, schedNextDaily(noon, SAT_NOON - 101));
+  uint32_t fired[3];
+  int count = 0;
+  while (w.cur <= SAT_NOON + 47 * 3600) {
+    uint32_t t = w.cur;
+    for (int8_t i = wheelStep(w); i >= 0;) {
+      int8_t n = w.next[i];
+      TEST_ASSERT_LESS_THAN(3, count);
+      fired[count++] = t;
+      wheelAdd(w, i, schedNextDaily(noon, t));
+      i = n;
+    }
+  }
+  TEST_ASSERT_EQUAL(3, count);
+  TEST_ASSERT_EQUAL_UINT32(SAT_NOON, fired[0]);
+  TEST_ASSERT_EQUAL_UINT32(SAT_NOON + 23 * 3600, fired[1]);
+  TEST_ASSERT_EQUAL_UINT32(SAT_NOON + 47 * 3600, fired[2]);
+}
+
+static void test_wheel_remove() {
+  sched_wheel_t w;
+  wheelReset(w, SAT_NOON);
+  wheelAdd(w, 0, SAT_NOON + 10);
+  wheelAdd(w, 1, SAT_NOON + 10);
+  wheelRemove(w, 0);
+  wheelRemove(w, 0); // not on the wheel anymore
+  int count = 0;
+  while (w.cur <= SAT_NOON + 10) {
+    for (int8_t i = wheelStep(w); i >= 0; i = w.next[i]) {
+      TEST_ASSERT_EQUAL(1, i);
+      count++;
+    }
+  }
+  TEST_ASSERT_EQUAL(1, count);
+}
+
+//STOPWATCH///////////////////////////////////////////////////////////////////////////////////////////////
+static void test_stopwatch_laps() {
+  swReset();
+  swStart(1000);
+  for (int i = 1; i <= SW_LAPS + 2; i++) {
+    TEST_ASSERT_TRUE(swLap(1000 + i * 100));
+  }
+  swStop(5000);
+  TEST_ASSERT_FALSE(swRunning());
+  TEST_ASSERT_EQUAL_INT64(4000, swElapsed(99999));
+  //the ring keeps the newest laps
+  TEST_ASSERT_EQUAL(SW_LAPS, swLapsKept());
+  sw_lap_t lap;
+  TEST_ASSERT_TRUE(swGetLap(0, lap));
+  TEST_ASSERT_EQUAL_UINT16(3, lap.number);
+  TEST_ASSERT_EQUAL_INT64(300, lap.splitUs);
+  TEST_ASSERT_EQUAL_INT64(100, lap.lapUs);
+  TEST_ASSERT_FALSE(swGetLap(SW_LAPS, lap));
+  //resume keeps the elapsed time
+  swStart(10000);
+  TEST_ASSERT_EQUAL_INT64(4500, swElapsed(10500));
+}
+
+int runTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_frame_digits_pins);
+  RUN_TEST(test_frame_blank);
+  RUN_TEST(test_frame_raw_round_trip);
+  RUN_TEST(test_digits_clock_date);
+  RUN_TEST(test_digits_elapsed_duration);
+  RUN_TEST(test_digits_percent);
+  RUN_TEST(test_show_ends_on_time);
+  RUN_TEST(test_show_advance);
+  RUN_TEST(test_next_daily_dst);
+  RUN_TEST(test_wheel_fires_on_time);
+  RUN_TEST(test_wheel_daily_repeat);
+  RUN_TEST(test_wheel_remove);
+  RUN_TEST(test_stopwatch_laps);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+
+void setup() {
+  delay(2000); // let the serial monitor attach
+  runTests();
+}
+
+void loop() {
+}
+#else
+int main() {
+  return runTests();
+}
+#endif
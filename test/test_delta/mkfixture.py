@@ -0,0 +1,61 @@
+"""
+mkfixture.py
+regenerates patch_fixture.h, the wm_mkpatch.py output the delta tests decode
+
+The images are not stored, both sides build them from the same xorshift32 stream:
+old is 200 KB of it, new has a block inserted near the start, pointer like fixups every 251
+bytes of a region that moved, a cut and new bytes at the end. Keep in step with test_main.cpp.
+
+usage
+  python test/test_delta/mkfixture.py
+"""
+
+import os
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(HERE, "..", "..", "lib", "WiFiManager", "extras"))
+import wm_mkpatch  # noqa: E402
+
+OLD_SIZE = 200 * 1024
+
+
+def stream(seed, n):
+    x = seed
+    out = bytearray(n)
+    for i in range(n):
+        x ^= (x << 13) & 0xFFFFFFFF
+        x ^= x >> 17
+        x ^= (x << 5) & 0xFFFFFFFF
+        out[i] = x & 0xFF
+    return out
+
+
+def images():
+    old = stream(1, OLD_SIZE)
+    extra = stream(2, 64 + 300)
+    moved = bytearray(old[50000:120000])
+    for i in range(0, len(moved), 251):
+        moved[i] = (moved[i] + 3) & 0xFF
+    new = old[:50000] + extra[:64] + moved + old[121000:] + extra[64:]
+    return bytes(old), bytes(new)
+
+
+def main():
+    old, new = images()
+    patch = wm_mkpatch.make(old, new)
+    if wm_mkpatch.apply(old, patch) != new:
+        raise SystemExit("mkfixture: round trip failed")
+    lines = ["// made by mkfixture.py from wm_mkpatch.py, do not edit",
+             "#define FIXTURE_NEW_SIZE %d" % len(new),
+             "static const uint8_t fixturePatch[%d] = {" % len(patch)]
+    for i in range(0, len(patch), 16):
+        lines.append("  " + ", ".join("0x%02x" % b for b in patch[i:i + 16]) + ",")
+    lines.append("};")
+    with open(os.path.join(HERE, "patch_fixture.h"), "w") as f:
+        f.write("\n".join(lines) + "\n")
+    print("mkfixture: %d byte patch of a %d byte image" % (len(patch), len(new)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,99 @@
+// made by mkfixture.py from wm_mkpatch.py, do not edit
+#define FIXTURE_NEW_SIZE 204164
+static const uint8_t fixturePatch[1516] = {
+  0x57, 0x4d, 0x44, 0x50, 0x01, 0x00, 0x00, 0x00, 0x00, 0x20, 0x03, 0x00, 0x99, 0x83, 0x20, 0x90,
+  0x84, 0x1d, 0x03, 0x00, 0x7c, 0x0f, 0x9a, 0x0e, 0xc0, 0x9a, 0x0c, 0x86, 0x02, 0x42, 0x02, 0x82,
+  0x06, 0x1a, 0x23, 0x59, 0xb6, 0x2a, 0x3b, 0xca, 0x3d, 0x09, 0x24, 0x3e, 0xfe, 0xbf, 0xff, 0x35,
+  0x9b, 0x88, 0xe8, 0x8a, 0x99, 0xe7, 0x64, 0x04, 0x35, 0x20, 0xd9, 0xc3, 0x77, 0xd1, 0x7b, 0x3d,
+  0x6a, 0x22, 0xa7, 0xe5, 0xdd, 0x54, 0x85, 0x15, 0xb6, 0x22, 0x03, 0x5c, 0x34, 0x4c, 0xf3, 0x9a,
+  0x70, 0x4c, 0xaa, 0xf7, 0x83, 0x60, 0x79, 0x91, 0xf9, 0xcd, 0x8f, 0x7c, 0xc2, 0x95, 0x0b, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xe8,
+  0x07, 0x05, 0x03, 0xe8, 0x07, 0x05, 0x03, 0xf4, 0x06, 0xc3, 0x3e, 0xe0, 0xba, 0x14, 0xb2, 0x09,
+  0x26, 0x30, 0x82, 0x56, 0x19, 0x8d, 0xe7, 0x73, 0xdc, 0x9e, 0x35, 0x3b, 0x5d, 0x9a, 0xd1, 0xd6,
+  0x0c, 0xa2, 0x43, 0xaa, 0xdd, 0x83, 0x53, 0x51, 0xef, 0x8e, 0x58, 0xb7, 0xff, 0xb2, 0x40, 0x42,
+  0x4d, 0x48, 0x3d, 0xc7, 0xbf, 0x2b, 0xed, 0x44, 0x81, 0x57, 0x0a, 0x90, 0xc7, 0x11, 0xad, 0x08,
+  0xf5, 0x27, 0xe4, 0x12, 0x99, 0x79, 0x72, 0xe3, 0x55, 0xd5, 0xe7, 0x9b, 0x15, 0x5c, 0x41, 0xe9,
+  0x63, 0x9f, 0x9d, 0xb0, 0x3a, 0x6b, 0xdd, 0x42, 0x7a, 0x79, 0x17, 0x9e, 0x2e, 0x36, 0xa6, 0xd2,
+  0x19, 0x08, 0xa8, 0x64, 0xf8, 0xa2, 0x17, 0xce, 0xfc, 0xae, 0xc5, 0x25, 0x39, 0x4c, 0x2e, 0x4d,
+  0x2d, 0x80, 0x8f, 0x38, 0xfe, 0x81, 0x07, 0x53, 0x36, 0x8a, 0x0b, 0x3e, 0x46, 0x18, 0xb2, 0x0a,
+  0x8b, 0xac, 0xcf, 0xe1, 0xaf, 0x8c, 0xc6, 0xe6, 0xe7, 0xd0, 0xb4, 0xb7, 0x85, 0x5b, 0xde, 0xf6,
+  0xb9, 0x92, 0x42, 0x73, 0x58, 0xe0, 0xba, 0x3b, 0x05, 0x4d, 0x17, 0x16, 0x5e, 0x4c, 0xc9, 0xa6,
+  0xae, 0x82, 0xfe, 0x58, 0x58, 0x10, 0x7f, 0x49, 0x74, 0x80, 0x5d, 0xf4, 0x29, 0x67, 0x83, 0x44,
+  0x4d, 0x27, 0x5b, 0x16, 0x77, 0xa0, 0x1e, 0xc2, 0x1f, 0x4c, 0x68, 0xd5, 0xd3, 0x40, 0xf5, 0x76,
+  0x2b, 0x1b, 0x09, 0x99, 0x00, 0xe1, 0xe9, 0xe0, 0x6e, 0x99, 0x90, 0xbb, 0x9c, 0xd3, 0x73, 0xee,
+  0xf6, 0x48, 0xd0, 0x1d, 0xd0, 0x77, 0x66, 0xe1, 0x05, 0xaa, 0x44, 0xe3, 0xe0, 0xe4, 0xc7, 0xfa,
+  0xe4, 0x7f, 0x5f, 0x21, 0xd1, 0x88, 0xd5, 0x3c, 0xdb, 0x27, 0x0e, 0x10, 0xde, 0x52, 0x59, 0x8b,
+  0x5f, 0x01, 0x3c, 0x1c, 0x93, 0xb8, 0xfb, 0x80, 0xe1, 0x23, 0x33, 0x65, 0xf7, 0x6e, 0x53, 0x4f,
+  0xce, 0x69, 0x86, 0x54, 0xac, 0xc4, 0xbf, 0x11, 0x14, 0x6d, 0x6f, 0xd9, 0xd9, 0x1a, 0xe9, 0x36,
+  0x48, 0x36, 0x8d, 0xf5, 0x0f, 0xce, 0xf5, 0x4d, 0x6d, 0x73, 0x15, 0xf6, 0xb8, 0xa9, 0x1d, 0x65,
+  0x4c, 0x25, 0xb9, 0x4f, 0xc9, 0xbd, 0x21, 0x3d, 0xf2, 0x19, 0x53, 0xa3, 0xc1, 0xfc, 0x40, 0x77,
+  0x11, 0xe4, 0x58, 0x38, 0x0f, 0x07, 0x7a, 0xee, 0x9d, 0xed, 0x54, 0x4b,
+};
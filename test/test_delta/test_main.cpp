@@ -0,0 +1,178 @@
+#include <unity.h>
+#include <string.h>
+#include <vector>
+#ifdef ARDUINO
+#include <wm_delta.h>
+#else
+//the WiFiManager library needs the framework and is ignored on native, the decoder doesn't
+#include "../../lib/WiFiManager/wm_delta.cpp"
+#endif
+#include "patch_fixture.h"
+
+//Same images as mkfixture.py, rebuilt from the xorshift32 stream instead of stored
+#define OLD_SIZE (200 * 1024)
+
+static std::vector<uint8_t> oldImage;
+static std::vector<uint8_t> newImage;
+static std::vector<uint8_t> out;      // what the decoder produced
+
+static std::vector<uint8_t> stream(uint32_t seed, size_t n) {
+  std::vector<uint8_t> bytes(n);
+  uint32_t x = seed;
+  for (size_t i = 0; i < n; i++) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    bytes[i] = x & 0xFF;
+  }
+  return bytes;
+}
+
+static void buildImages() {
+  oldImage = stream(1, OLD_SIZE);
+  std::vector<uint8_t> extra = stream(2, 64 + 300);
+  std::vector<uint8_t> moved(oldImage.begin() + 50000, oldImage.begin() + 120000);
+  for (size_t i = 0; i < moved.size(); i += 251) {
+    moved[i] += 3;
+  }
+  newImage.assign(oldImage.begin(), oldImage.begin() + 50000);
+  newImage.insert(newImage.end(), extra.begin(), extra.begin() + 64);
+  newImage.insert(newImage.end(), moved.begin(), moved.end());
+  newImage.insert(newImage.end(), oldImage.begin() + 121000, oldImage.end());
+  newImage.insert(newImage.end(), extra.begin() + 64, extra.end());
+}
+
+static bool readOld(void *ctx, uint32_t off, uint8_t *buf, size_t len) {
+  const std::vector<uint8_t> &base = *(const std::vector<uint8_t> *)ctx;
+  if (off + len > base.size()) {
+    return false;
+  }
+  memcpy(buf, base.data() + off, len);
+  return true;
+}
+
+static bool writeNew(void *ctx, const uint8_t *buf, size_t len) {
+  out.insert(out.end(), buf, buf + len);
+  return true;
+}
+
+//Feeds patch in pieces of split bytes against base, returns the first error of feed or end
+static wm_delta_err_t decode(const uint8_t *patch, size_t len, size_t split,
+                             const std::vector<uint8_t> &base = oldImage) {
+  WMDelta delta;
+  out.clear();
+  delta.begin(readOld, writeNew, (void *)&base);
+  for (size_t off = 0; off < len; off += split) {
+    wm_delta_err_t err = delta.feed(patch + off, len - off < split ? len - off : split);
+    if (err != WM_DELTA_OK) {
+      return err;
+    }
+  }
+  return delta.end();
+}
+
+//Header of a hand made patch against base
+static std::vector<uint8_t> header(const std::vector<uint8_t> &base, uint32_t newSize, uint32_t newCrc) {
+  std::vector<uint8_t> h(WM_DELTA_HDRSIZE, 0);
+  memcpy(h.data(), WM_DELTA_MAGIC, 4);
+  h[4] = WM_DELTA_VERSION;
+  uint32_t fields[4] = {(uint32_t)base.size(), WMDelta::crc32(0, base.data(), base.size()), newSize, newCrc};
+  for (int f = 0; f < 4; f++) {
+    for (int b = 0; b < 4; b++) {
+      h[8 + f * 4 + b] = fields[f] >> (b * 8);
+    }
+  }
+  return h;
+}
+
+void setUp() {
+  if (oldImage.empty()) {
+    buildImages();
+  }
+}
+
+void tearDown() {
+}
+
+static void test_fixture_matches_images() {
+  TEST_ASSERT_EQUAL(FIXTURE_NEW_SIZE, newImage.size());
+  TEST_ASSERT_TRUE(WMDelta::isPatch(fixturePatch, sizeof(fixturePatch)));
+}
+
+//any split of the upload decodes to the same image
+static void test_round_trip_splits() {
+  const size_t splits[] = {1, 7, 1436, 100000};
+  for (size_t split : splits) {
+    TEST_ASSERT_EQUAL(WM_DELTA_OK, decode(fixturePatch, sizeof(fixturePatch), split));
+    TEST_ASSERT_EQUAL(newImage.size(), out.size());
+    TEST_ASSERT_TRUE(out == newImage);
+  }
+}
+
+static void test_err_base() {
+  std::vector<uint8_t> other = oldImage;
+  other[OLD_SIZE / 2] ^= 1;
+  TEST_ASSERT_EQUAL(WM_DELTA_ERR_BASE, decode(fixturePatch, sizeof(fixturePatch), 1436, other));
+  TEST_ASSERT_EQUAL(0, out.size()); // nothing written for the wrong base
+}
+
+static void test_err_truncated() {
+  TEST_ASSERT_EQUAL(WM_DELTA_ERR_TRUNCATED, decode(fixturePatch, sizeof(fixturePatch) - 1, 7));
+  TEST_ASSERT_EQUAL(WM_DELTA_ERR_TRUNCATED, decode(fixturePatch, WM_DELTA_HDRSIZE - 1, 7));
+}
+
+static void test_err_trailing() {
+  std::vector<uint8_t> patch(fixturePatch, fixturePatch + sizeof(fixturePatch));
+  patch.push_back(0);
+  TEST_ASSERT_EQUAL(WM_DELTA_ERR_TRAILING, decode(patch.data(), patch.size(), 100000));
+}
+
+static void test_err_range() {
+  const std::vector<uint8_t> base(oldImage.begin(), oldImage.begin() + 16);
+  //COPY of more than the new size
+  std::vector<uint8_t> patch = header(base, 8, 0);
+  patch.push_back(9 << 2 | WM_DELTA_COPY);
+  TEST_ASSERT_EQUAL(WM_DELTA_ERR_RANGE, decode(patch.data(), patch.size(), 1, base));
+  //COPY past the end of the old image
+  patch = header(base, 32, 0);
+  patch.push_back(17 << 2 | WM_DELTA_COPY);
+  TEST_ASSERT_EQUAL(WM_DELTA_ERR_RANGE, decode(patch.data(), patch.size(), 1, base));
+  //SEEK before the start, zigzag 3 is -2
+  patch = header(base, 8, 0);
+  patch.push_back(3 << 2 | WM_DELTA_SEEK);
+  TEST_ASSERT_EQUAL(WM_DELTA_ERR_RANGE, decode(patch.data(), patch.size(), 1, base));
+}
+
+static void test_err_crc() {
+  std::vector<uint8_t> patch(fixturePatch, fixturePatch + sizeof(fixturePatch));
+  patch[20] ^= 1; // new image crc
+  TEST_ASSERT_EQUAL(WM_DELTA_ERR_CRC, decode(patch.data(), patch.size(), 1436));
+}
+
+int runTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_fixture_matches_images);
+  RUN_TEST(test_round_trip_splits);
+  RUN_TEST(test_err_base);
+  RUN_TEST(test_err_truncated);
+  RUN_TEST(test_err_trailing);
+  RUN_TEST(test_err_range);
+  RUN_TEST(test_err_crc);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+
+void setup() {
+  delay(2000); // let the serial monitor attach
+  runTests();
+}
+
+void loop() {
+}
+#else
+int main() {
+  return runTests();
+}
+#endif
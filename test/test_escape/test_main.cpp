@@ -0,0 +1,130 @@
+#include <unity.h>
+#include <string.h>
+#include <string>
+#ifdef ARDUINO
+#include <wm_escape.h>
+#else
+//the WiFiManager library needs the framework and is ignored on native, the escaper doesn't
+#include "../../lib/WiFiManager/wm_escape.cpp"
+#endif
+
+#define FUZZ_RUNS 20000
+#define FUZZ_LEN  48
+
+//The replace chain htmlEntities() used before the single pass escaper, plus &quot; in attributes
+static std::string replaceAll(std::string str, const char *from, const char *to) {
+  size_t len = strlen(from);
+  for (size_t pos = str.find(from); pos != std::string::npos; pos = str.find(from, pos + strlen(to))) {
+    str.replace(pos, len, to);
+  }
+  return str;
+}
+
+static std::string reference(const std::string &in, wm_escape_t ctx) {
+  std::string str = replaceAll(in, "&", "&amp;");
+  str = replaceAll(str, "<", "&lt;");
+  str = replaceAll(str, ">", "&gt;");
+  str = replaceAll(str, "'", "&#39;");
+  if (ctx == WM_ESC_TEXT) {
+    str = replaceAll(str, " ", "&#160;");
+  }
+  else {
+    str = replaceAll(str, "\"", "&quot;");
+  }
+  return str;
+}
+
+//xorshift32, fixed seed so a failure repeats
+static uint32_t rng = 2463534242UL;
+
+static uint32_t next() {
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+//Mostly the characters that get escaped, and whatever else a ssid may hold
+static std::string randomString() {
+  static const char special[] = "&<>'\" ;#a";
+  std::string s;
+  size_t len = next() % (FUZZ_LEN + 1);
+  for (size_t i = 0; i < len; i++) {
+    uint32_t r = next();
+    s += (r & 1) ? special[(r >> 1) % (sizeof(special) - 1)] : (char)(1 + (r >> 8) % 255);
+  }
+  return s;
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+static void test_known() {
+  char buf[WM_ESCAPE_BUFSIZE];
+  wmEscape(buf, sizeof(buf), "a \"b\" <c> & 'd'", WM_ESC_ATTR);
+  TEST_ASSERT_EQUAL_STRING("a &quot;b&quot; &lt;c&gt; &amp; &#39;d&#39;", buf);
+  wmEscape(buf, sizeof(buf), "a \"b\" <c>", WM_ESC_TEXT);
+  TEST_ASSERT_EQUAL_STRING("a&#160;\"b\"&#160;&lt;c&gt;", buf);
+}
+
+//same output and length as the replace chain for random input in both contexts
+static void test_fuzz_equivalence() {
+  char buf[FUZZ_LEN * 6 + 1];
+  for (int run = 0; run < FUZZ_RUNS; run++) {
+    std::string in = randomString();
+    wm_escape_t ctx = (run & 1) ? WM_ESC_TEXT : WM_ESC_ATTR;
+    std::string want = reference(in, ctx);
+    TEST_ASSERT_EQUAL(want.size(), wmEscapeLen(in.c_str(), ctx));
+    TEST_ASSERT_EQUAL(want.size(), wmEscape(buf, sizeof(buf), in.c_str(), ctx));
+    TEST_ASSERT_EQUAL_STRING(want.c_str(), buf);
+  }
+}
+
+//a short buffer gets a terminated prefix that ends on a whole entity
+static void test_fuzz_truncation() {
+  char buf[FUZZ_LEN * 6 + 1];
+  for (int run = 0; run < FUZZ_RUNS; run++) {
+    std::string in = randomString();
+    wm_escape_t ctx = (run & 1) ? WM_ESC_TEXT : WM_ESC_ATTR;
+    std::string want = reference(in, ctx);
+    size_t size = 1 + next() % (want.size() + 1);
+    size_t n = wmEscape(buf, size, in.c_str(), ctx);
+    TEST_ASSERT_TRUE(n < size);
+    TEST_ASSERT_EQUAL(n, strlen(buf));
+    TEST_ASSERT_EQUAL(0, want.compare(0, n, buf));
+    //the prefix is the escape of some prefix of the input
+    size_t k = 0;
+    while (k < in.size() && reference(in.substr(0, k + 1), ctx).size() <= n) {
+      k++;
+    }
+    TEST_ASSERT_EQUAL(reference(in.substr(0, k), ctx).size(), n);
+  }
+  TEST_ASSERT_EQUAL(0, wmEscape(buf, 0, "&", WM_ESC_ATTR));
+}
+
+int runTests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_known);
+  RUN_TEST(test_fuzz_equivalence);
+  RUN_TEST(test_fuzz_truncation);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+
+void setup() {
+  delay(2000); // let the serial monitor attach
+  runTests();
+}
+
+void loop() {
+}
+#else
+int main() {
+  return runTests();
+}
+#endif